@@ -23,10 +23,13 @@
 #include "client.h" //for XBMC->Log
 #include "argustvrpc.h"
 #include "EventsThread.h"
+#include "pvrclient-argustv.h"
 
 using namespace ADDON;
 
-CEventsThread::CEventsThread(void)
+CEventsThread::CEventsThread(cPVRClientArgusTV* client) :
+  m_client(client),
+  m_subscribed(false)
 {
   XBMC->Log(LOG_DEBUG, "CEventsThread:: constructor");
 }
@@ -128,6 +131,7 @@ void CEventsThread::HandleEvents(Json::Value events)
   if (mustUpdateRecordings)
   {
     XBMC->Log(LOG_DEBUG, "CEventsThread:: Recordings update triggered");
+    m_client->InvalidateRecordings();
     PVR->TriggerRecordingUpdate();
   }
 }
@@ -22,10 +22,12 @@
 
 #include "platform/threads/threads.h"
 
+class cPVRClientArgusTV;
+
 class CEventsThread : public PLATFORM::CThread
 {
 public:
-  CEventsThread(void);
+  CEventsThread(cPVRClientArgusTV* client);
   ~CEventsThread(void);
   void Connect(void);
 private:
@@ -33,6 +35,7 @@ private:
 
   void HandleEvents(Json::Value events);
 
+  cPVRClientArgusTV* m_client;
   bool m_subscribed;
   std::string m_monitorId;
 };
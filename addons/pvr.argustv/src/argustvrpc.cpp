@@ -726,6 +726,36 @@ namespace ArgusTV
     return retval;
   }
 
+  int GetFullRecordings(Json::Value& response)
+  {
+    XBMC->Log(LOG_DEBUG, "GetFullRecordings");
+    std::string command = "ArgusTV/Control/GetFullRecordings/Television?includeNonExisting=false";
+    // An empty filter matches the recordings of all titles
+    Json::Value jsArgument;
+    jsArgument["ScheduleId"] = Json::nullValue;
+    jsArgument["ProgramTitle"] = Json::nullValue;
+    jsArgument["Category"] = Json::nullValue;
+    jsArgument["ChannelId"] = Json::nullValue;
+    Json::FastWriter writer;
+    std::string arguments = writer.write(jsArgument);
+
+    int retval = ArgusTV::ArgusTVJSONRPC(command, arguments, response);
+    if (retval >= 0)
+    {
+      if (response.type() != Json::arrayValue)
+      {
+        retval = E_FAILED;
+        XBMC->Log(LOG_NOTICE, "GetFullRecordings did not return a Json::arrayValue [%d].", response.type());
+      }
+    }
+    else
+    {
+      XBMC->Log(LOG_NOTICE, "GetFullRecordings remote call failed. (%d)", retval);
+    }
+
+    return retval;
+  }
+
   int GetRecordingById(const std::string& id, Json::Value& response)
   {
     XBMC->Log(LOG_DEBUG, "GetRecordingById");
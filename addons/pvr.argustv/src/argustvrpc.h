@@ -209,6 +209,12 @@ namespace ArgusTV
    */
   int GetFullRecordingsForTitle(const std::string& title, Json::Value& response);
 
+  /**
+   * \brief Fetch the detailed data for all recordings in a single request
+   * \param response Reference to a std::string used to store the json response string
+   */
+  int GetFullRecordings(Json::Value& response);
+
   /**
    * \brief Fetch the detailed information of a recorded show
    * \param id unique id (guid) of the recording
@@ -29,7 +29,7 @@
 
 #include "TSReader.h"
 #include "client.h" //for XBMC->Log
-#include "MultiFileReader.h"
+#include "tsreader/MultiFileReader.h"
 #include "utils.h"
 #include "platform/os.h"
 
@@ -73,7 +73,7 @@ long CTsReader::Open(const char* pszFileName)
   }
 
   //open file
-  if (m_fileReader->SetFileName(m_fileName.c_str()) != S_OK)
+  if (m_fileReader->SetFileName(m_fileName) != S_OK)
   {
     XBMC->Log(LOG_ERROR, "CTsReader::SetFileName failed.");
     return S_FALSE;
@@ -150,7 +150,8 @@ int64_t CTsReader::GetFilePointer()
 
 void CTsReader::OnZap(void)
 {
-  m_fileReader->OnZap();
+  m_fileReader->SetFilePointer(0LL, FILE_END);
+  m_fileReader->OnChannelChange();
 }
 
 #if defined(TARGET_WINDOWS)
@@ -29,7 +29,7 @@
  *************************************************************************/
 
 #include "client.h"
-#include "FileReader.h"
+#include "tsreader/FileReader.h"
 #include "platform/util/StdString.h"
 
 class CTsReader
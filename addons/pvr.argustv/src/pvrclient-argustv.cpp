@@ -41,6 +41,7 @@ using namespace PLATFORM;
 
 #define SIGNALQUALITY_INTERVAL 10
 #define MAXLIFETIME 99 //Based on VDR addon and VDR documentation. 99=Keep forever, 0=can be deleted at any time, 1..98=days to keep
+#define RECORDINGS_CACHE_MAX_AGE 300000 //Milliseconds before the recordings are reloaded without a recording event, catches changes made by other clients
 
 
 /************************************************************/
@@ -57,7 +58,9 @@ cPVRClientArgusTV::cPVRClientArgusTV()
   m_epg_id_offset          = 0;
   m_iCurrentChannel        = -1;
   m_keepalive              = new CKeepAliveThread();
-  m_eventmonitor           = new CEventsThread();
+  m_eventmonitor           = new CEventsThread(this);
+  m_bRecordingsCacheValid  = false;
+  m_iRecordingsCacheTime   = 0;
   m_TVChannels.clear();
   m_RadioChannels.clear();
   // due to lack of static constructors, we initialize manually
@@ -439,12 +442,10 @@ PVR_ERROR cPVRClientArgusTV::GetChannels(ADDON_HANDLE handle, bool bRadio)
     if (bRadio)
     {
       FreeChannels(m_RadioChannels);
-      m_RadioChannels.clear();
     }
     else
     {
       FreeChannels(m_TVChannels);
-      m_TVChannels.clear();
     }
     int size = response.size();
 
@@ -471,13 +472,17 @@ PVR_ERROR cPVRClientArgusTV::GetChannels(ADDON_HANDLE handle, bool bRadio)
 
         if (!tag.bIsRadio)
         {
-          m_TVChannels.push_back(channel);
+          cChannel*& entry = m_TVChannels[channel->ID()];
+          delete entry; // ARGUS TV ids are unique, this only drops a duplicate in the list
+          entry = channel;
           XBMC->Log(LOG_DEBUG, "Found TV channel: %s, Unique id: %d, ARGUS LCN: %d, ARGUS Id: %d, ARGUS GUID: %s\n",  
             channel->Name(), tag.iUniqueId, tag.iChannelNumber, channel->ID(), channel->Guid().c_str());  
         }
         else
         {
-          m_RadioChannels.push_back(channel);
+          cChannel*& entry = m_RadioChannels[channel->ID()];
+          delete entry; // ARGUS TV ids are unique, this only drops a duplicate in the list
+          entry = channel;
           XBMC->Log(LOG_DEBUG, "Found Radio channel: %s, Unique id: %d, ARGUS LCN: %d, ARGUS Id: %d, ARGUS GUID: %s\n",  
             channel->Name(), tag.iUniqueId, tag.iChannelNumber, channel->ID(), channel->Guid().c_str());  
         }
@@ -626,95 +631,117 @@ PVR_ERROR cPVRClientArgusTV::GetChannelGroupMembers(ADDON_HANDLE handle, const P
 
 int cPVRClientArgusTV::GetNumRecordings(void)
 {
-  Json::Value response;
-  int retval = -1;
-  int iNumRecordings = 0;
-
   XBMC->Log(LOG_DEBUG, "GetNumRecordings()");
-  retval = ArgusTV::GetRecordingGroupByTitle(response);
-  if (retval >= 0)
+
+  CLockObject lock(m_RecordingsCacheMutex);
+  if (!LoadRecordings())
+    return 0;
+
+  return (int) m_RecordingsCache.size();
+}
+
+PVR_ERROR cPVRClientArgusTV::GetRecordings(ADDON_HANDLE handle)
+{
+  XBMC->Log(LOG_DEBUG, "RequestRecordingsList()");
+
+  CLockObject lock(m_RecordingsCacheMutex);
+  if (!LoadRecordings())
+    return PVR_ERROR_NO_ERROR;
+
+  // Titles having more than one recording are shown as a directory
+  std::map<std::string, int> titleCounts;
+  for (std::vector<cRecording>::const_iterator it = m_RecordingsCache.begin(); it != m_RecordingsCache.end(); ++it)
   {
-    int size = response.size();
+    titleCounts[it->Title()]++;
+  }
 
-    // parse channelgroup list
-    for ( int index = 0; index < size; ++index )
+  for (std::vector<cRecording>::const_iterator it = m_RecordingsCache.begin(); it != m_RecordingsCache.end(); ++it)
+  {
+    cRecording recording = *it;
+    PVR_RECORDING tag;
+    memset(&tag, 0 , sizeof(tag));
+
+    strncpy(tag.strRecordingId, recording.RecordingId(), sizeof(tag.strRecordingId));
+    strncpy(tag.strChannelName, recording.ChannelDisplayName(), sizeof(tag.strChannelName));
+    tag.iLifetime      = MAXLIFETIME; //TODO: recording.Lifetime();
+    tag.iPriority      = recording.SchedulePriority();
+    tag.recordingTime  = recording.RecordingStartTime();
+    tag.iDuration      = recording.RecordingStopTime() - recording.RecordingStartTime();
+    strncpy(tag.strPlot, recording.Description(), sizeof(tag.strPlot));
+    tag.iPlayCount     = recording.FullyWatchedCount();
+    tag.iLastPlayedPosition = recording.LastWatchedPosition();
+    if (titleCounts[recording.Title()] > 1)
     {
-      cRecordingGroup recordinggroup;
-      if (recordinggroup.Parse(response[index]))
-      {
-        iNumRecordings += recordinggroup.RecordingsCount();
-      }
+      strncpy(tag.strDirectory, recording.Title(), sizeof(tag.strDirectory)); //used in XBMC as directory structure below "Server X - hostname"
+      recording.Transform(true);
     }
+    else
+    {
+      recording.Transform(false);
+      tag.strDirectory[0] = '\0';
+    }
+    strncpy(tag.strTitle, recording.Title(), sizeof(tag.strTitle));
+    strncpy(tag.strPlotOutline, recording.SubTitle(), sizeof(tag.strPlotOutline));
+    strncpy(tag.strStreamURL, recording.RecordingFileName(), sizeof(tag.strStreamURL));
+    PVR->TransferRecordingEntry(handle, &tag);
   }
-  return iNumRecordings;
+  return PVR_ERROR_NO_ERROR;
 }
 
-PVR_ERROR cPVRClientArgusTV::GetRecordings(ADDON_HANDLE handle)
+void cPVRClientArgusTV::InvalidateRecordings(void)
 {
-  Json::Value recordinggroupresponse;
-  int retval = -1;
-  int iNumRecordings = 0;
+  CLockObject lock(m_RecordingsCacheMutex);
+  m_bRecordingsCacheValid = false;
+}
 
-  XBMC->Log(LOG_DEBUG, "RequestRecordingsList()");
+/*
+ * \brief Fill the recordings cache with the recordings of all titles in one request, when it is not up to date
+ * The caller must hold m_RecordingsCacheMutex.
+ */
+bool cPVRClientArgusTV::LoadRecordings(void)
+{
+  if (m_bRecordingsCacheValid && (GetTimeMs() - m_iRecordingsCacheTime < RECORDINGS_CACHE_MAX_AGE))
+    return true;
+
+  Json::Value response;
   int64_t t = GetTimeMs();
-  retval = ArgusTV::GetRecordingGroupByTitle(recordinggroupresponse);
-  if(retval >= 0)
-  {           
-    // process list of recording groups
-    int size = recordinggroupresponse.size();
-    for ( int recordinggroupindex = 0; recordinggroupindex < size; ++recordinggroupindex )
-    {
-      cRecordingGroup recordinggroup;
-      if (recordinggroup.Parse(recordinggroupresponse[recordinggroupindex]))
-      {
-        Json::Value recordingsbytitleresponse;
-        retval = ArgusTV::GetFullRecordingsForTitle(recordinggroup.ProgramTitle(), recordingsbytitleresponse);
-        if (retval >= 0)
-        {
-          // process list of recording details for this group
-          int nrOfRecordings = recordingsbytitleresponse.size();
-          for (int recordingindex = 0; recordingindex < nrOfRecordings; recordingindex++)
-          {
-            cRecording recording;
+  int retval = ArgusTV::GetFullRecordings(response);
+  if (retval < 0)
+    return false;
 
-            if (recording.Parse(recordingsbytitleresponse[recordingindex]))
-            {
-              PVR_RECORDING tag;
-              memset(&tag, 0 , sizeof(tag));
-
-              strncpy(tag.strRecordingId, recording.RecordingId(), sizeof(tag.strRecordingId));
-              strncpy(tag.strChannelName, recording.ChannelDisplayName(), sizeof(tag.strChannelName));
-              tag.iLifetime      = MAXLIFETIME; //TODO: recording.Lifetime();
-              tag.iPriority      = recording.SchedulePriority();
-              tag.recordingTime  = recording.RecordingStartTime();
-              tag.iDuration      = recording.RecordingStopTime() - recording.RecordingStartTime();
-              strncpy(tag.strPlot, recording.Description(), sizeof(tag.strPlot));
-              tag.iPlayCount     = recording.FullyWatchedCount();
-              tag.iLastPlayedPosition = recording.LastWatchedPosition();
-              if (nrOfRecordings > 1)
-              {
-                recording.Transform(true);
-                strncpy(tag.strDirectory, recordinggroup.ProgramTitle().c_str(), sizeof(tag.strDirectory)); //used in XBMC as directory structure below "Server X - hostname"
-              }
-              else
-              {
-                recording.Transform(false);
-                tag.strDirectory[0] = '\0';
-              }
-              strncpy(tag.strTitle, recording.Title(), sizeof(tag.strTitle));
-              strncpy(tag.strPlotOutline, recording.SubTitle(), sizeof(tag.strPlotOutline));
-              strncpy(tag.strStreamURL, recording.RecordingFileName(), sizeof(tag.strStreamURL));
-              PVR->TransferRecordingEntry(handle, &tag);
-              iNumRecordings++;
-            }
-          }
-        }
-      }
+  // Only the parsed recordings are kept, the PVR_RECORDING tags are built when they are transferred
+  int size = response.size();
+  std::vector<cRecording> recordings;
+  recordings.reserve(size);
+  for (int recordingindex = 0; recordingindex < size; recordingindex++)
+  {
+    cRecording recording;
+    if (recording.Parse(response[recordingindex]))
+    {
+      recordings.push_back(recording);
     }
   }
-  t = GetTimeMs() - t;
-  XBMC->Log(LOG_INFO, "Retrieving %d recordings took %d milliseconds.", iNumRecordings, t);
-  return PVR_ERROR_NO_ERROR;
+  m_RecordingsCache.swap(recordings);
+
+  m_bRecordingsCacheValid = true;
+  m_iRecordingsCacheTime = GetTimeMs();
+  t = m_iRecordingsCacheTime - t;
+  XBMC->Log(LOG_INFO, "Retrieving %d recordings took %d milliseconds.", (int) m_RecordingsCache.size(), (int) t);
+  return true;
+}
+
+/*
+ * \brief Find a recording in the recordings cache, NULL when it is not there
+ * The caller must hold m_RecordingsCacheMutex.
+ */
+cRecording* cPVRClientArgusTV::FindCachedRecording(const char* recordingId)
+{
+  for (std::vector<cRecording>::iterator it = m_RecordingsCache.begin(); it != m_RecordingsCache.end(); ++it)
+  {
+    if (strcmp(it->RecordingId(), recordingId) == 0)
+      return &(*it);
+  }
+  return NULL;
 }
 
 PVR_ERROR cPVRClientArgusTV::DeleteRecording(const PVR_RECORDING &recinfo)
@@ -731,6 +758,7 @@ PVR_ERROR cPVRClientArgusTV::DeleteRecording(const PVR_RECORDING &recinfo)
   std::string jsonval = writer.write(recordingname);
   if (ArgusTV::DeleteRecording(jsonval) >= 0)
   {
+    InvalidateRecordings();
     // Trigger XBMC to update it's list
     PVR->TriggerRecordingUpdate();
     rc =  PVR_ERROR_NO_ERROR;
@@ -762,6 +790,11 @@ PVR_ERROR cPVRClientArgusTV::SetRecordingLastPlayedPosition(const PVR_RECORDING
     return PVR_ERROR_SERVER_ERROR;
   }
 
+  CLockObject lock(m_RecordingsCacheMutex);
+  cRecording* cached = FindCachedRecording(recinfo.strRecordingId);
+  if (cached)
+    cached->SetLastWatchedPosition(lastplayedposition);
+
   return PVR_ERROR_NO_ERROR;
 }
 
@@ -806,6 +839,11 @@ PVR_ERROR cPVRClientArgusTV::SetRecordingPlayCount(const PVR_RECORDING &recinfo,
     return PVR_ERROR_SERVER_ERROR;
   }
 
+  CLockObject lock(m_RecordingsCacheMutex);
+  cRecording* cached = FindCachedRecording(recinfo.strRecordingId);
+  if (cached)
+    cached->SetFullyWatchedCount(playcount);
+
   return PVR_ERROR_NO_ERROR;
 }
 
@@ -1122,33 +1160,29 @@ cChannel* cPVRClientArgusTV::FetchChannel(int channelid, bool LogError)
   return rc;
 }
 
-cChannel* cPVRClientArgusTV::FetchChannel(std::vector<cChannel*> m_Channels, int channelid, bool LogError)
+cChannel* cPVRClientArgusTV::FetchChannel(const std::map<int, cChannel*>& channels, int channelid, bool LogError)
 {
   CLockObject lock(m_ChannelCacheMutex);
-  // Search for this channel in our local channel list to find the original ChannelID back:
-  vector<cChannel*>::iterator it;
-
-  for ( it=m_Channels.begin(); it < m_Channels.end(); it++ )
+  // Look up this channel in our local channel cache to find the original ChannelID back:
+  std::map<int, cChannel*>::const_iterator it = channels.find(channelid);
+  if (it != channels.end())
   {
-    if ((*it)->ID() == channelid)
-    {
-      return *it;
-    }
+    return it->second;
   }
 
   if (LogError) XBMC->Log(LOG_ERROR, "XBMC channel with id %d not found in the channel cache!.", channelid);
   return NULL;
 }
 
-void cPVRClientArgusTV::FreeChannels(std::vector<cChannel*> m_Channels)
+void cPVRClientArgusTV::FreeChannels(std::map<int, cChannel*>& channels)
 {
-  // Search for this channel in our local channel list to find the original ChannelID back:
-  vector<cChannel*>::iterator it;
+  std::map<int, cChannel*>::iterator it;
 
-  for ( it=m_Channels.begin(); it < m_Channels.end(); it++ )
+  for ( it=channels.begin(); it != channels.end(); it++ )
   {
-    SAFE_DELETE(*it);
+    SAFE_DELETE(it->second);
   }
+  channels.clear();
 }
 
 bool cPVRClientArgusTV::_OpenLiveStream(const PVR_CHANNEL &channelinfo)
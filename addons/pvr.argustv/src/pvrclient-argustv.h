@@ -20,6 +20,7 @@
 #include "platform/os.h"
 
 #include <vector>
+#include <map>
 
 /* Master defines for client control */
 #include "xbmc_pvr_types.h"
@@ -74,6 +75,7 @@ public:
   PVR_ERROR SetRecordingLastPlayedPosition(const PVR_RECORDING &recinfo, int lastplayedposition);
   int GetRecordingLastPlayedPosition(const PVR_RECORDING &recinfo);
   PVR_ERROR SetRecordingPlayCount(const PVR_RECORDING &recinfo, int playcount);
+  void InvalidateRecordings(void);
 
   /* Timer handling */
   int GetNumTimers(void);
@@ -108,10 +110,12 @@ public:
 
 private:
   cChannel* FetchChannel(int channelid, bool LogError = true);
-  cChannel* FetchChannel(std::vector<cChannel*> m_Channels, int channelid, bool LogError = true);
-  void FreeChannels(std::vector<cChannel*> m_Channels);
+  cChannel* FetchChannel(const std::map<int, cChannel*>& channels, int channelid, bool LogError = true);
+  void FreeChannels(std::map<int, cChannel*>& channels);
   void Close();
   bool _OpenLiveStream(const PVR_CHANNEL &channel);
+  bool LoadRecordings(void);
+  cRecording* FindCachedRecording(const char* recordingId);
 
   int                     m_iCurrentChannel;
   bool                    m_bConnected;
@@ -124,8 +128,12 @@ private:
   time_t                  m_BackendTime;
 
   PLATFORM::CMutex        m_ChannelCacheMutex;
-  std::vector<cChannel*>   m_TVChannels; // Local TV channel cache list needed for id to guid conversion
-  std::vector<cChannel*>   m_RadioChannels; // Local Radio channel cache list needed for id to guid conversion
+  std::map<int, cChannel*> m_TVChannels; // Local TV channel cache by id, needed for id to guid conversion
+  std::map<int, cChannel*> m_RadioChannels; // Local Radio channel cache by id, needed for id to guid conversion
+  PLATFORM::CMutex        m_RecordingsCacheMutex;
+  std::vector<cRecording> m_RecordingsCache; // Local recordings cache, reloaded when ARGUS TV reports recording changes
+  bool                    m_bRecordingsCacheValid;
+  int64_t                 m_iRecordingsCacheTime;
   int                     m_epg_id_offset;
   int                     m_signalqualityInterval;
   CTsReader*              m_tsreader;
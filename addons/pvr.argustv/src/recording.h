@@ -73,6 +73,8 @@ public:
   bool Parse(const Json::Value& data);
 
   void Transform(bool isgroupmember);
+  void SetLastWatchedPosition(int position) { lastwatchedposition = position; }
+  void SetFullyWatchedCount(int count) { fullywatchedcount = count; }
   int Id(void) const { return id; }
   const char *Actors(void) const { return actors.c_str(); }
   const char *Category(void) const { return category.c_str(); }
@@ -74,6 +74,9 @@ DVBLinkClient::DVBLinkClient(CHelper_libXBMC_addon* xbmc, CHelper_libXBMC_pvr* p
   setting_margins_supported_ = false;
   favorites_supported_ = false;
   transcoding_supported_ = false;
+  epg_cache_start_ = 0;
+  epg_cache_end_ = 0;
+  epg_cache_time_ = 0;
 
   m_httpClient = new HttpPostClient(XBMC,hostname, port, username, password);
   m_dvblinkRemoteCommunication = DVBLinkRemote::Connect((HttpClient&)*m_httpClient, m_hostname.c_str(), port, username.c_str(), password.c_str());
@@ -280,15 +283,10 @@ int DVBLinkClient::GetTimersAmount()
 
 int DVBLinkClient::GetInternalUniqueIdFromChannelId(const std::string& channelId)
 {
-  for (std::map<int,Channel*>::iterator it=m_channelMap.begin(); it!=m_channelMap.end(); ++it)
-  {
-    Channel * channel = (*it).second;
-    int id = (*it).first;
-    if (channelId.compare(channel->GetID()) == 0)
-    {
-      return id;
-    }
-  }
+  std::map<std::string, int>::iterator it = inverse_channel_map_.find(channelId);
+  if (it != inverse_channel_map_.end())
+    return it->second;
+
   return 0;
 }
 
@@ -393,6 +391,18 @@ bool DVBLinkClient::get_dvblink_program_id(std::string& channelId, int start_tim
 {
     bool ret_val = false;
 
+    //programs sent to the guide are known already
+    channel_program_id_map_t::iterator ch_it = program_ids_.find(channelId);
+    if (ch_it != program_ids_.end())
+    {
+        start_time_to_program_id_map_t::iterator it = ch_it->second.find(start_time);
+        if (it != ch_it->second.end())
+        {
+            dvblink_program_id = it->second;
+            return true;
+        }
+    }
+
     EpgSearchResult epgSearchResult;
     if (DoEPGSearch(epgSearchResult, channelId, start_time, start_time))
     {
@@ -1023,57 +1033,169 @@ bool  DVBLinkClient::DoEPGSearch(EpgSearchResult& epgSearchResult, const std::st
   return false;
 }
 
+dvblinkremote::ChannelEpgData* DVBLinkClient::take_prefetched_epg(const std::string& channelId, time_t start_time, time_t end_time)
+{
+  //the cache only serves the time window it was filled for, and only for a while
+  if (!epg_cache_.empty() && (start_time < epg_cache_start_ || end_time > epg_cache_end_ || 
+      time(NULL) - epg_cache_time_ > DVBLINK_EPG_CACHE_TIMEOUT))
+  {
+    clear_epg_cache();
+  }
+
+  if (epg_cache_.empty())
+  {
+    epg_cache_start_ = start_time;
+    epg_cache_end_ = end_time;
+    epg_cache_time_ = time(NULL);
+  }
+
+  channel_epg_map_t::iterator it = epg_cache_.find(channelId);
+  if (it == epg_cache_.end())
+  {
+    if (!prefetch_epg(channelId))
+      return NULL;
+
+    it = epg_cache_.find(channelId);
+    if (it == epg_cache_.end())
+      return NULL;
+  }
+
+  //every channel is asked once per guide update, so its data is handed over
+  ChannelEpgData* channelEpgData = it->second;
+  epg_cache_.erase(it);
+  return channelEpgData;
+}
+
+bool DVBLinkClient::prefetch_epg(const std::string& channelId)
+{
+  //the requested channel and the next ones not fetched yet, in channel order
+  ChannelIdentifierList channelIds;
+  channelIds.push_back(channelId);
+
+  std::map<std::string, int>::iterator id_it = inverse_channel_map_.find(channelId);
+  if (id_it != inverse_channel_map_.end())
+  {
+    std::map<int, Channel*>::iterator ch_it = m_channelMap.upper_bound(id_it->second);
+    for (; ch_it != m_channelMap.end() && channelIds.size() < DVBLINK_EPG_BATCH_SIZE; ch_it++)
+    {
+      if (epg_cache_.find(ch_it->second->GetID()) == epg_cache_.end())
+        channelIds.push_back(ch_it->second->GetID());
+    }
+  }
+
+  EpgSearchRequest epgSearchRequest(channelIds, epg_cache_start_, epg_cache_end_);
+  EpgSearchResult epgSearchResult;
+
+  DVBLinkRemoteStatusCode status;
+  if ((status = m_dvblinkRemoteCommunication->SearchEpg(epgSearchRequest, epgSearchResult)) != DVBLINK_REMOTE_STATUS_OK)
+  {
+    std::string error;
+    m_dvblinkRemoteCommunication->GetLastError(error);
+    XBMC->Log(LOG_ERROR, "Could not get EPG for %d channels (Error code : %d Description : %s)", (int)channelIds.size(), (int)status, error.c_str());
+    return false;
+  }
+
+  //take the channel data over from the result
+  for (std::vector<ChannelEpgData*>::iterator it = epgSearchResult.begin(); it < epgSearchResult.end(); it++) 
+  {
+    if (!epg_cache_.insert(std::make_pair((*it)->GetChannelID(), *it)).second)
+      delete *it;
+  }
+  epgSearchResult.clear();
+
+  //channels without programs are not asked for again
+  for (ChannelIdentifierList::iterator it = channelIds.begin(); it < channelIds.end(); it++)
+  {
+    if (epg_cache_.find(*it) == epg_cache_.end())
+      epg_cache_[*it] = new ChannelEpgData(*it);
+  }
+
+  return true;
+}
+
+void DVBLinkClient::clear_epg_cache()
+{
+  for (channel_epg_map_t::iterator it = epg_cache_.begin(); it != epg_cache_.end(); it++)
+  {
+    delete it->second;
+  }
+  epg_cache_.clear();
+}
+
+void DVBLinkClient::index_program_ids(const std::string& channelId, EpgData& epgData, time_t start_time, time_t end_time)
+{
+  start_time_to_program_id_map_t& program_ids = program_ids_[channelId];
+
+  //programs that ended before the window are no longer in the guide, only the
+  //last one starting before it can still be running
+  start_time_to_program_id_map_t::iterator first = program_ids.lower_bound(start_time);
+  if (first != program_ids.begin())
+    program_ids.erase(program_ids.begin(), --first);
+
+  //the fetched window replaces what was known for it
+  program_ids.erase(program_ids.lower_bound(start_time), program_ids.upper_bound(end_time));
+
+  for (std::vector<Program*>::iterator it = epgData.begin(); it < epgData.end(); it++) 
+  {
+    program_ids[(*it)->GetStartTime()] = (*it)->GetID();
+  }
+}
+
 PVR_ERROR DVBLinkClient::GetEPGForChannel(ADDON_HANDLE handle, const PVR_CHANNEL& channel, time_t iStart, time_t iEnd)
 {
   PVR_ERROR result = PVR_ERROR_FAILED;
   PLATFORM::CLockObject critsec(m_mutex);
   Channel * c = m_channelMap[channel.iUniqueId];
-  EpgSearchResult epgSearchResult;
+  ChannelEpgData* channelEpgData = take_prefetched_epg(c->GetID(), iStart, iEnd);
 
-  if (DoEPGSearch(epgSearchResult,c->GetID(), iStart, iEnd))
+  if (channelEpgData != NULL)
   {
-    for (std::vector<ChannelEpgData*>::iterator it = epgSearchResult.begin(); it < epgSearchResult.end(); it++) 
-    {
-      ChannelEpgData* channelEpgData = (ChannelEpgData*)*it;
-      EpgData& epgData = channelEpgData->GetEpgData();
-      for (std::vector<Program*>::iterator pIt = epgData.begin(); pIt < epgData.end(); pIt++) 
-      {
-        Program* p = (Program*)*pIt;
-        EPG_TAG broadcast;
-        memset(&broadcast, 0, sizeof(EPG_TAG));
-
-        broadcast.iUniqueBroadcastId = p->GetStartTime();
-        broadcast.strTitle = p->GetTitle().c_str();
-        broadcast.iChannelNumber      = channel.iChannelNumber;
-        broadcast.startTime           = p->GetStartTime();
-        broadcast.endTime             = p->GetStartTime() + p->GetDuration();
-        broadcast.strPlotOutline      = p->SubTitle.c_str();
-        broadcast.strPlot             = p->ShortDescription.c_str();
-        
-        broadcast.strIconPath         = p->Image.c_str();
-        broadcast.iGenreType          = 0;
-        broadcast.iGenreSubType       = 0;
-        broadcast.strGenreDescription = "";
-        broadcast.firstAired          = 0;
-        broadcast.iParentalRating     = 0;
-        broadcast.iStarRating         = p->Rating;
-        broadcast.bNotify             = false;
-        broadcast.iSeriesNumber       = p->SeasonNumber;
-        broadcast.iEpisodeNumber      = p->EpisodeNumber;
-        broadcast.iEpisodePartNumber  = 0;
-        broadcast.strEpisodeName      = p->SubTitle.c_str();
+    EpgData& epgData = channelEpgData->GetEpgData();
+    index_program_ids(c->GetID(), epgData, iStart, iEnd);
 
-        int genre_type, genre_subtype;
-        SetEPGGenre(*p, genre_type, genre_subtype);
-        broadcast.iGenreType = genre_type;
-        if (genre_type == EPG_GENRE_USE_STRING)
-          broadcast.strGenreDescription = p->Keywords.c_str();
-        else
-          broadcast.iGenreSubType = genre_subtype;
-
-        PVR->TransferEpgEntry(handle, &broadcast);
-      }
+    for (std::vector<Program*>::iterator pIt = epgData.begin(); pIt < epgData.end(); pIt++) 
+    {
+      Program* p = (Program*)*pIt;
+
+      //the prefetched window may be wider than the requested one
+      if (p->GetStartTime() + p->GetDuration() < iStart || p->GetStartTime() > iEnd)
+        continue;
+
+      EPG_TAG broadcast;
+      memset(&broadcast, 0, sizeof(EPG_TAG));
+
+      broadcast.iUniqueBroadcastId = p->GetStartTime();
+      broadcast.strTitle = p->GetTitle().c_str();
+      broadcast.iChannelNumber      = channel.iChannelNumber;
+      broadcast.startTime           = p->GetStartTime();
+      broadcast.endTime             = p->GetStartTime() + p->GetDuration();
+      broadcast.strPlotOutline      = p->SubTitle.c_str();
+      broadcast.strPlot             = p->ShortDescription.c_str();
+      
+      broadcast.strIconPath         = p->Image.c_str();
+      broadcast.iGenreType          = 0;
+      broadcast.iGenreSubType       = 0;
+      broadcast.strGenreDescription = "";
+      broadcast.firstAired          = 0;
+      broadcast.iParentalRating     = 0;
+      broadcast.iStarRating         = p->Rating;
+      broadcast.bNotify             = false;
+      broadcast.iSeriesNumber       = p->SeasonNumber;
+      broadcast.iEpisodeNumber      = p->EpisodeNumber;
+      broadcast.iEpisodePartNumber  = 0;
+      broadcast.strEpisodeName      = p->SubTitle.c_str();
+
+      int genre_type, genre_subtype;
+      SetEPGGenre(*p, genre_type, genre_subtype);
+      broadcast.iGenreType = genre_type;
+      if (genre_type == EPG_GENRE_USE_STRING)
+        broadcast.strGenreDescription = p->Keywords.c_str();
+      else
+        broadcast.iGenreSubType = genre_subtype;
+
+      PVR->TransferEpgEntry(handle, &broadcast);
     }
+    delete channelEpgData;
     result = PVR_ERROR_NO_ERROR;
   }
   else
@@ -1091,6 +1213,7 @@ DVBLinkClient::~DVBLinkClient(void)
     StopThread();
   }
   
+  clear_epg_cache();
   SAFE_DELETE(m_dvblinkRemoteCommunication);
   SAFE_DELETE(m_httpClient);
   SAFE_DELETE(m_channels);
@@ -43,6 +43,12 @@
 #define DVBLINK_RECODINGS_BY_SERIES_ID   "0E03FEB8-BD8F-46e7-B3EF-34F6890FB458"
 
 typedef std::map<std::string, std::string> recording_id_to_url_map_t;
+typedef std::map<std::string, dvblinkremote::ChannelEpgData*> channel_epg_map_t;
+typedef std::map<long, std::string> start_time_to_program_id_map_t;
+typedef std::map<std::string, start_time_to_program_id_map_t> channel_program_id_map_t;
+
+#define DVBLINK_EPG_BATCH_SIZE     50    // channels requested by one epg search
+#define DVBLINK_EPG_CACHE_TIMEOUT  600   // seconds a prefetched guide is served
 
 class DVBLinkClient : public PLATFORM::CThread
 {
@@ -93,6 +99,11 @@ private:
   std::string make_timer_hash(const std::string& timer_id, const std::string& schedule_id);
   bool parse_timer_hash(const char* timer_hash, std::string& timer_id, std::string& schedule_id);
 
+  dvblinkremote::ChannelEpgData* take_prefetched_epg(const std::string& channelId, time_t start_time, time_t end_time);
+  bool prefetch_epg(const std::string& channelId);
+  void clear_epg_cache();
+  void index_program_ids(const std::string& channelId, dvblinkremote::EpgData& epgData, time_t start_time, time_t end_time);
+
   HttpPostClient* m_httpClient; 
   dvblinkremote::IDVBLinkRemoteConnection* m_dvblinkRemoteCommunication;
   bool m_connected;
@@ -123,6 +134,11 @@ private:
   dvblinkremote::ChannelFavorites channel_favorites_;
   std::map<std::string, int> inverse_channel_map_;
   bool no_group_single_rec_;
+  channel_epg_map_t epg_cache_;
+  time_t epg_cache_start_;
+  time_t epg_cache_end_;
+  time_t epg_cache_time_;
+  channel_program_id_map_t program_ids_;
 };
 
 /*!
@@ -25,6 +25,7 @@
  
 #include "HttpPostClient.h"
 #include "base64.h"
+#include <algorithm>
 
 using namespace dvblinkremotehttp;
 using namespace ADDON;
@@ -44,9 +45,11 @@ using namespace ADDON;
 
 
 
-#define SEND_RQ(MSG) \
-  /*cout<<send_str;*/ \
-  send(sock,MSG,strlen(MSG),0);
+#ifdef MSG_NOSIGNAL
+  #define SEND_FLAGS MSG_NOSIGNAL //a closed keep-alive connection must not raise SIGPIPE
+#else
+  #define SEND_FLAGS 0
+#endif
 
 
 /* Converts a hex character to its integer value */
@@ -88,29 +91,10 @@ HttpPostClient::HttpPostClient(CHelper_libXBMC_addon  *XBMC, const std::string&
   m_serverport = serverport;
   m_username = username;
   m_password = password;
-}
-
-int HttpPostClient::SendPostRequest(HttpWebRequest& request)
-{
-  int ret_code = -100;
-  std::string buffer;
-  std::string message;
-  char content_header[100];
-
-  buffer.append("POST /cs/ HTTP/1.0\r\n");
-  sprintf(content_header,"Host: %s:%d\r\n",m_server.c_str(),(int)m_serverport);
-  buffer.append(content_header);
-  buffer.append("Content-Type: application/x-www-form-urlencoded\r\n");
-  if (m_username.compare("") != 0)
-  {
-    sprintf(content_header,"%s:%s",m_username.c_str(),m_password.c_str());
-    sprintf(content_header, "Authorization: Basic %s\r\n",base64_encode((const char*)content_header,strlen(content_header)).c_str());
-    buffer.append(content_header);
-  }
-  sprintf(content_header,"Content-Length: %ld\r\n",request.ContentLength);
-  buffer.append(content_header);
-  buffer.append("\r\n");
-  buffer.append(request.GetRequestData());
+  m_lastReqeuestErrorCode = 0;
+  m_sock = -1;
+  m_addressResolved = false;
+  m_serverAddress = 0;
 
   #ifdef TARGET_WINDOWS
   {
@@ -118,74 +102,279 @@ int HttpPostClient::SendPostRequest(HttpWebRequest& request)
     WSAStartup(0x0101, &WsaData);
   }
   #endif
+}
+
+HttpPostClient::~HttpPostClient()
+{
+  CloseConnection();
+}
+
+int HttpPostClient::Connect()
+{
+  if (!m_addressResolved)
+  {
+    struct hostent * host_addr = gethostbyname(m_server.c_str());
+    if (host_addr==NULL)
+    {
+      return -103;
+    }
+    m_serverAddress = *((int*)*host_addr->h_addr_list);
+    m_addressResolved = true;
+  }
 
-  sockaddr_in sin;
   int sock = socket(AF_INET, SOCK_STREAM, 0);
   if (sock == -1)
   {
     return -100;
   }
+
+  sockaddr_in sin;
+  memset(&sin, 0, sizeof(sin));
   sin.sin_family = AF_INET;
   sin.sin_port = htons((unsigned short)m_serverport); 
+  sin.sin_addr.s_addr = m_serverAddress;
 
-  struct hostent * host_addr = gethostbyname(m_server.c_str());
-  if (host_addr==NULL)
+  if (connect(sock, (const struct sockaddr *)&sin, sizeof(sockaddr_in)) == -1 )
   {
-    return -103;
+    close(sock);
+    //the server may have moved, resolve its name again next time
+    m_addressResolved = false;
+    return -101;
   }
-  sin.sin_addr.s_addr = *((int*)*host_addr->h_addr_list) ;
 
-  if (connect(sock, (const struct sockaddr *)&sin, sizeof(sockaddr_in)) == -1 )
+  m_sock = sock;
+  m_readBuffer.clear();
+  return 0;
+}
+
+void HttpPostClient::CloseConnection()
+{
+  if (m_sock != -1)
   {
-    return -101;
+    close(m_sock);
+    m_sock = -1;
   }
+  m_readBuffer.clear();
+}
 
-  SEND_RQ(buffer.c_str());
+bool HttpPostClient::SendData(const std::string& data)
+{
+  const char* ptr = data.c_str();
+  size_t left = data.size();
+  while (left > 0)
+  {
+    int sent = send(m_sock, ptr, left, SEND_FLAGS);
+    if (sent <= 0)
+    {
+      return false;
+    }
+    ptr += sent;
+    left -= sent;
+  }
+  return true;
+}
 
-  const int read_buffer_size = 4096;
+bool HttpPostClient::ReceiveData()
+{
+  const int read_buffer_size = 16384;
   char read_buffer[read_buffer_size];
-  int read_size = 0;
-  std::string response;
-  while ((read_size = recv(sock, read_buffer, read_buffer_size, 0)) > 0)
-      response.append(read_buffer, read_buffer + read_size);
+  int read_size = recv(m_sock, read_buffer, read_buffer_size, 0);
+  if (read_size <= 0)
+  {
+    return false;
+  }
+  m_readBuffer.append(read_buffer, read_size);
+  return true;
+}
+
+static bool get_header_value(const std::string& headers, const char* name, std::string& value)
+{
+  //headers are matched case-insensitively, at the start of a line
+  std::string lower_headers = headers;
+  std::transform(lower_headers.begin(), lower_headers.end(), lower_headers.begin(), ::tolower);
+
+  std::string line_start = "\r\n";
+  line_start.append(name);
+  line_start.append(":");
+
+  std::string::size_type n = lower_headers.find(line_start);
+  if (n == std::string::npos)
+  {
+    return false;
+  }
+
+  n += line_start.size();
+  std::string::size_type end = headers.find("\r\n", n);
+  value = headers.substr(n, end == std::string::npos ? std::string::npos : end - n);
+  value.erase(0, value.find_first_not_of(" \t"));
+  std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+  return true;
+}
+
+bool HttpPostClient::ReadChunkedBody()
+{
+  m_responseData.clear();
+  while (true)
+  {
+    std::string::size_type line_end;
+    while ((line_end = m_readBuffer.find("\r\n")) == std::string::npos)
+    {
+      if (!ReceiveData())
+        return false;
+    }
 
-  close(sock);
+    long chunk_size = strtol(m_readBuffer.c_str(), NULL, 16);
+    m_readBuffer.erase(0, line_end + 2);
 
-  if (response.size() > 0)
+    if (chunk_size <= 0)
+    {
+      //skip the trailers up to the empty line
+      while ((line_end = m_readBuffer.find("\r\n")) != 0)
+      {
+        if (line_end != std::string::npos)
+          m_readBuffer.erase(0, line_end + 2);
+        else if (!ReceiveData())
+          return false;
+      }
+      m_readBuffer.erase(0, 2);
+      return true;
+    }
+
+    while (m_readBuffer.size() < (size_t)chunk_size + 2)
+    {
+      if (!ReceiveData())
+        return false;
+    }
+    m_responseData.append(m_readBuffer, 0, chunk_size);
+    m_readBuffer.erase(0, chunk_size + 2);
+  }
+}
+
+int HttpPostClient::ReadResponse()
+{
+  int ret_code = -100;
+
+  std::string::size_type header_end;
+  while ((header_end = m_readBuffer.find("\r\n\r\n")) == std::string::npos)
   {
-      //header
-      std::string::size_type n = response.find("\r\n");
-      if (n != std::string::npos)
+    if (!ReceiveData())
+    {
+      ret_code = m_readBuffer.empty() ? -102 : -104;
+      CloseConnection();
+      return ret_code;
+    }
+  }
+
+  std::string headers = m_readBuffer.substr(0, header_end + 2);
+  m_readBuffer.erase(0, header_end + 4);
+
+  std::string status_line = headers.substr(0, headers.find("\r\n"));
+  if (status_line.find("200 OK") != std::string::npos)
+    ret_code = 200;
+  if (status_line.find("401 Unauthorized") != std::string::npos)
+    ret_code = -401;
+
+  //HTTP/1.0 servers close the connection unless told otherwise
+  std::string value;
+  bool keep_alive = status_line.compare(0, 8, "HTTP/1.1") == 0;
+  if (get_header_value(headers, "connection", value))
+    keep_alive = value.find("close") == std::string::npos && (keep_alive || value.find("keep-alive") != std::string::npos);
+
+  bool body_read = true;
+  if (get_header_value(headers, "transfer-encoding", value) && value.find("chunked") != std::string::npos)
+  {
+    body_read = ReadChunkedBody();
+  }
+  else if (get_header_value(headers, "content-length", value))
+  {
+    size_t content_length = strtoul(value.c_str(), NULL, 10);
+    if (m_readBuffer.capacity() < content_length)
+      m_readBuffer.reserve(content_length);
+
+    while (body_read && m_readBuffer.size() < content_length)
+      body_read = ReceiveData();
+
+    if (body_read)
+    {
+      if (m_readBuffer.size() == content_length)
       {
-          std::string header = response.substr(0, n);
-          if (header.find("200 OK") != std::string::npos)
-            ret_code = 200;
-          if (header.find("401 Unauthorized") != std::string::npos)
-              ret_code = -401;
-
-          if (ret_code == 200)
-          {
-              //body
-              const char* body_sep = "\r\n\r\n";
-              n = response.find(body_sep);
-              if (n != std::string::npos)
-              {
-                  m_responseData.assign(response.c_str() + n + strlen(body_sep));
-              } else
-              {
-                  ret_code = -105;
-              }
-          }
+        m_responseData.swap(m_readBuffer);
+        m_readBuffer.clear();
       }
       else
       {
-          ret_code = -104;
+        m_responseData.assign(m_readBuffer, 0, content_length);
+        m_readBuffer.erase(0, content_length);
       }
+    }
   }
   else
   {
-    ret_code = -102;
+    //the body ends with the connection
+    while (ReceiveData())
+      ;
+    m_responseData.swap(m_readBuffer);
+    m_readBuffer.clear();
+    keep_alive = false;
   }
+
+  if (!keep_alive || !body_read)
+    CloseConnection();
+
+  if (ret_code == 200 && !body_read)
+    ret_code = -105;
+
+  return ret_code;
+}
+
+int HttpPostClient::SendPostRequest(HttpWebRequest& request)
+{
+  std::string buffer;
+  char content_header[100];
+
+  buffer.append("POST /cs/ HTTP/1.1\r\n");
+  sprintf(content_header,"Host: %s:%d\r\n",m_server.c_str(),(int)m_serverport);
+  buffer.append(content_header);
+  buffer.append("Connection: keep-alive\r\n");
+  buffer.append("Content-Type: application/x-www-form-urlencoded\r\n");
+  if (m_username.compare("") != 0)
+  {
+    sprintf(content_header,"%s:%s",m_username.c_str(),m_password.c_str());
+    sprintf(content_header, "Authorization: Basic %s\r\n",base64_encode((const char*)content_header,strlen(content_header)).c_str());
+    buffer.append(content_header);
+  }
+  sprintf(content_header,"Content-Length: %ld\r\n",request.ContentLength);
+  buffer.append(content_header);
+  buffer.append("\r\n");
+  buffer.append(request.GetRequestData());
+
+  //the server may have closed a kept alive connection meanwhile, so a request
+  //getting no answer at all on a reused connection is sent once more on a new one
+  for (int attempt = 0; attempt < 2; attempt++)
+  {
+    bool reused = (m_sock != -1);
+    if (!reused)
+    {
+      int ret_code = Connect();
+      if (ret_code != 0)
+        return ret_code;
+    }
+
+    if (!SendData(buffer))
+    {
+      CloseConnection();
+      if (reused)
+        continue;
+      return -102;
+    }
+
+    int ret_code = ReadResponse();
+    if (ret_code == -102 && reused)
+      continue;
+
+    return ret_code;
+  }
+
   //TODO: Use xbmc file code when it allows to post content-type application/x-www-form-urlencoded and authentication
   /*
   void* hFile = XBMC->OpenFileForWrite(request.GetUrl().c_str(), 0);
@@ -216,7 +405,7 @@ int HttpPostClient::SendPostRequest(HttpWebRequest& request)
 
   */
 
-  return ret_code;
+  return -102;
 }
 
 bool HttpPostClient::SendRequest(HttpWebRequest& request)
@@ -231,7 +420,9 @@ HttpWebResponse* HttpPostClient::GetResponse()
   {
     return NULL;
   }
-  HttpWebResponse* response = new HttpWebResponse(200, m_responseData);
+  //hand the body over instead of copying it
+  HttpWebResponse* response = new HttpWebResponse(200, "");
+  response->GetResponseData().swap(m_responseData);
   return response;
 }
 
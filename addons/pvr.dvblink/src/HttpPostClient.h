@@ -37,9 +37,16 @@ public :
   void GetLastError(std::string& err);
   void UrlEncode(const std::string& str, std::string& outEncodedStr);
   HttpPostClient(ADDON::CHelper_libXBMC_addon *XBMC, const std::string& server, const int serverport, const std::string& username, const std::string& password);
+  ~HttpPostClient();
 
 private :
   int SendPostRequest(dvblinkremotehttp::HttpWebRequest& request);
+  int Connect();
+  void CloseConnection();
+  bool SendData(const std::string& data);
+  bool ReceiveData();
+  int ReadResponse();
+  bool ReadChunkedBody();
   std::string m_server;
   long m_serverport;
   std::string m_username;
@@ -47,5 +54,8 @@ private :
   ADDON::CHelper_libXBMC_addon  *XBMC;
   std::string m_responseData;
   int m_lastReqeuestErrorCode;
-
+  int m_sock;                     // kept alive between requests, -1 when not connected
+  bool m_addressResolved;
+  unsigned long m_serverAddress;  // cached address of m_server, network byte order
+  std::string m_readBuffer;       // received data not parsed yet
 };
@@ -40,26 +40,34 @@ RecordingStreamer::RecordingStreamer(ADDON::CHelper_libXBMC_addon* xbmc, const s
 
 RecordingStreamer::~RecordingStreamer()
 {
+    CloseRecordedStream();
     delete dvblink_remote_con_;
     delete http_client_;
 }
 
 bool RecordingStreamer::OpenRecordedStream(const char* recording_id, std::string& url)
 {
+    CloseRecordedStream();
+
     recording_id_ = recording_id;
     url_ = url;
     cur_pos_ = 0;
 
-    prev_check_ = time(NULL);
     get_recording_info(recording_id_, recording_size_, is_in_recording_);
 
-    playback_handle_ = xbmc_->OpenFile(url_.c_str(), 0);
+    reopen_playback_handle();
+
+    //the size of a recording in progress is refreshed apart from reading
+    if (playback_handle_ != NULL && is_in_recording_)
+        CreateThread();
 
     return playback_handle_ != NULL;
 }
 
 void RecordingStreamer::CloseRecordedStream(void)
 {
+    stop_info_thread();
+
     if (playback_handle_ != NULL)
     {
         xbmc_->CloseFile(playback_handle_);
@@ -67,26 +75,69 @@ void RecordingStreamer::CloseRecordedStream(void)
     }
 }
 
-int RecordingStreamer::ReadRecordedStream(unsigned char *pBuffer, unsigned int iBufferSize)
+bool RecordingStreamer::reopen_playback_handle()
 {
-    //if this is recording in progress - update its size every minute
-    if (is_in_recording_)
+    if (playback_handle_ != NULL)
+        xbmc_->CloseFile(playback_handle_);
+
+    playback_handle_ = xbmc_->OpenFile(url_.c_str(), 0);
+    handle_size_ = playback_handle_ != NULL ? xbmc_->GetFileLength(playback_handle_) : 0;
+
+    return playback_handle_ != NULL;
+}
+
+void RecordingStreamer::stop_info_thread()
+{
+    if (IsRunning())
     {
-        time_t now = time(NULL);
-        if (now - prev_check_ > check_delta_)
-        {
-            get_recording_info(recording_id_, recording_size_, is_in_recording_);
+        StopThread(-1);
+        stop_event_.Signal();
+        StopThread();
+    }
+}
 
-            //reopen original data connection to refresh its file size
-            xbmc_->CloseFile(playback_handle_);
-            playback_handle_ = xbmc_->OpenFile(url_.c_str(), 0);
-            xbmc_->SeekFile(playback_handle_, cur_pos_, SEEK_SET);
+void *RecordingStreamer::Process()
+{
+    bool is_in_recording = true;
+    while (is_in_recording && !IsStopped())
+    {
+        stop_event_.Wait((uint32_t)check_delta_ * 1000);
+        if (IsStopped())
+            break;
 
-            prev_check_ = now;
+        long long recording_size;
+        if (get_recording_info(recording_id_, recording_size, is_in_recording))
+        {
+            PLATFORM::CLockObject lock(info_mutex_);
+            recording_size_ = recording_size;
+            is_in_recording_ = is_in_recording;
+        }
+        else
+        {
+            is_in_recording = true;
         }
     }
+    return NULL;
+}
+
+int RecordingStreamer::ReadRecordedStream(unsigned char *pBuffer, unsigned int iBufferSize)
+{
+    if (playback_handle_ == NULL)
+        return 0;
 
     unsigned int n = xbmc_->ReadFile(playback_handle_, pBuffer, iBufferSize);
+
+    //the data connection ends at the size the recording had when it was opened,
+    //it is only reopened when the recording has grown beyond that
+    if (n == 0 && cur_pos_ < LengthRecordedStream())
+    {
+        if (!reopen_playback_handle())
+            return 0;
+
+        xbmc_->SeekFile(playback_handle_, cur_pos_, SEEK_SET);
+        n = xbmc_->ReadFile(playback_handle_, pBuffer, iBufferSize);
+    }
+
     cur_pos_ += n;
 
     return n;
@@ -94,8 +145,35 @@ int RecordingStreamer::ReadRecordedStream(unsigned char *pBuffer, unsigned int i
 
 long long RecordingStreamer::SeekRecordedStream(long long iPosition, int iWhence /* = SEEK_SET */)
 {
-    cur_pos_ = xbmc_->SeekFile(playback_handle_, iPosition, iWhence);
-    return cur_pos_;
+    if (playback_handle_ == NULL)
+        return -1;
+
+    long long position = iPosition;
+    if (iWhence == SEEK_CUR)
+        position += cur_pos_;
+    else if (iWhence == SEEK_END)
+        position += LengthRecordedStream();
+    else if (iWhence != SEEK_SET)
+        return xbmc_->SeekFile(playback_handle_, iPosition, iWhence);
+
+    //the data connection can't seek beyond the size the recording had when it
+    //was opened, reopen it when the recording has grown up to the target since
+    bool can_reopen = position <= LengthRecordedStream();
+    if (handle_size_ > 0 && position > handle_size_ && can_reopen)
+    {
+        if (!reopen_playback_handle())
+            return -1;
+        can_reopen = false;
+    }
+
+    long long new_pos = xbmc_->SeekFile(playback_handle_, position, SEEK_SET);
+    if (new_pos < 0 && can_reopen && reopen_playback_handle())
+        new_pos = xbmc_->SeekFile(playback_handle_, position, SEEK_SET);
+
+    if (new_pos >= 0)
+        cur_pos_ = new_pos;
+
+    return new_pos;
 }
 
 long long RecordingStreamer::PositionRecordedStream(void)
@@ -105,6 +183,7 @@ long long RecordingStreamer::PositionRecordedStream(void)
 
 long long RecordingStreamer::LengthRecordedStream(void)
 {
+    PLATFORM::CLockObject lock(info_mutex_);
     return recording_size_;
 }
 
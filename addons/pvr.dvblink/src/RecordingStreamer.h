@@ -28,8 +28,10 @@
 #include "libXBMC_addon.h"
 #include "libdvblinkremote/dvblinkremote.h"
 #include "HttpPostClient.h"
+#include "platform/threads/threads.h"
+#include "platform/threads/mutex.h"
 
-class RecordingStreamer
+class RecordingStreamer : public PLATFORM::CThread
 {
 public :
     RecordingStreamer(ADDON::CHelper_libXBMC_addon* xbmc, const std::string& client_id, const std::string& hostname, long port, const std::string& username, const std::string& password);
@@ -42,12 +44,17 @@ public :
     long long PositionRecordedStream(void);
     long long LengthRecordedStream(void);
 protected:
+    virtual void * Process(void);
+    void stop_info_thread();
+    bool reopen_playback_handle();
+
     ADDON::CHelper_libXBMC_addon* xbmc_;
     std::string recording_id_;
     std::string url_;
     long long recording_size_;
     bool is_in_recording_;
     void* playback_handle_;
+    long long handle_size_;
     long long cur_pos_;
     std::string client_id_;
     std::string hostname_;
@@ -56,8 +63,10 @@ protected:
     HttpPostClient* http_client_;
     dvblinkremote::IDVBLinkRemoteConnection* dvblink_remote_con_;
     long port_;
-    time_t prev_check_;
     time_t check_delta_;
+    //size and state of a recording in progress, refreshed by the thread
+    PLATFORM::CMutex info_mutex_;
+    PLATFORM::CEvent stop_event_;
 
     bool get_recording_info(const std::string& recording_id, long long& recording_size, bool& is_in_recording);
 };
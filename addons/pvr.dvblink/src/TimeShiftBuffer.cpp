@@ -94,12 +94,88 @@ StreamRequest* LiveTVStreamer::GetStreamRequest(long dvblink_channel_id, const s
 TimeShiftBuffer::TimeShiftBuffer(CHelper_libXBMC_addon* XBMC) :
     LiveStreamerBase(XBMC)
 {
-  last_pos_req_time_ = -1;
-  last_pos_ = 0;
+  stats_valid_ = false;
+  stats_length_ = 0;
+  stats_duration_ = 0;
+  stats_cur_pos_ = 0;
+  stats_generation_ = 0;
 }
 
 TimeShiftBuffer::~TimeShiftBuffer(void)
 {
+  Stop();
+}
+
+bool TimeShiftBuffer::Start(std::string& streampath)
+{
+  if (!LiveStreamerBase::Start(streampath))
+    return false;
+
+  UpdateBufferParams();
+  CreateThread();
+  return true;
+}
+
+void TimeShiftBuffer::Stop()
+{
+  if (IsRunning())
+  {
+    StopThread(-1);
+    stop_event_.Signal();
+    StopThread();
+  }
+
+  LiveStreamerBase::Stop();
+
+  PLATFORM::CLockObject lock(stats_mutex_);
+  stats_valid_ = false;
+}
+
+void *TimeShiftBuffer::Process()
+{
+  while (!IsStopped())
+  {
+    stop_event_.Wait(DVBLINK_TIMESHIFT_STATS_INTERVAL);
+    if (!IsStopped())
+      UpdateBufferParams();
+  }
+  return NULL;
+}
+
+void TimeShiftBuffer::UpdateBufferParams()
+{
+  unsigned int generation;
+  {
+    PLATFORM::CLockObject lock(stats_mutex_);
+    generation = stats_generation_;
+  }
+
+  long long length, cur_pos;
+  time_t duration;
+  if (GetBufferParams(length, duration, cur_pos))
+  {
+    PLATFORM::CLockObject lock(stats_mutex_);
+    //a request started before a seek may complete after it
+    if (generation != stats_generation_)
+      return;
+
+    stats_length_ = length;
+    stats_duration_ = duration;
+    stats_cur_pos_ = cur_pos;
+    stats_valid_ = true;
+  }
+}
+
+bool TimeShiftBuffer::GetCachedBufferParams(long long& length, time_t& duration, long long& cur_pos)
+{
+  PLATFORM::CLockObject lock(stats_mutex_);
+  if (!stats_valid_)
+    return false;
+
+  length = stats_length_;
+  duration = stats_duration_;
+  cur_pos = stats_cur_pos_;
+  return true;
 }
 
 StreamRequest* TimeShiftBuffer::GetStreamRequest(long dvblink_channel_id, const std::string& client_id, const std::string& host_name,
@@ -147,9 +223,18 @@ long long TimeShiftBuffer::Seek(long long iPosition, int iWhence)
     ret_val = atoll(response_values[0].c_str());
   }
 
+  //statistics requested before the seek completed are out of date
+  {
+    PLATFORM::CLockObject lock(stats_mutex_);
+    stats_generation_++;
+  }
+
   //restart streaming
   m_streamHandle = XBMC->OpenFile(streampath_.c_str(), 0);
 
+  //the cached position is out of date now
+  UpdateBufferParams();
+
   return ret_val;
 }
 
@@ -159,7 +244,7 @@ long long TimeShiftBuffer::Position()
 
   time_t duration;
   long long length;
-  GetBufferParams(length, duration, ret_val);
+  GetCachedBufferParams(length, duration, ret_val);
 
   return ret_val;
 }
@@ -201,7 +286,7 @@ long long TimeShiftBuffer::Length()
 
   time_t duration;
   long long cur_pos;
-  GetBufferParams(ret_val, duration, cur_pos);
+  GetCachedBufferParams(ret_val, duration, cur_pos);
 
   return ret_val;
 }
@@ -228,26 +313,15 @@ bool TimeShiftBuffer::GetBufferParams(long long& length, time_t& duration, long
 
 time_t TimeShiftBuffer::GetPlayingTime()
 {
-  time_t ret_val = last_pos_;
-
   time_t now;
   now = time(NULL);
 
-  if (last_pos_req_time_ == -1 || now > last_pos_req_time_ + 1)
-  {
-    long long length, cur_pos;
-    time_t duration;
-    if (GetBufferParams(length, duration, cur_pos))
-    {
-        if (length > 0)
-            ret_val = now - (time_t)((length - cur_pos) * duration / length);
-        else
-            ret_val = now;
-    }
+  time_t ret_val = now;
 
-    last_pos_ = ret_val;
-    last_pos_req_time_ = now;
-  }
+  long long length, cur_pos;
+  time_t duration;
+  if (GetCachedBufferParams(length, duration, cur_pos) && length > 0)
+    ret_val = now - (time_t)((length - cur_pos) * duration / length);
 
   return ret_val;
 }
@@ -261,7 +335,7 @@ time_t TimeShiftBuffer::GetBufferTimeStart()
 
   long long length, cur_pos;
   time_t duration;
-  if (GetBufferParams(length, duration, cur_pos))
+  if (GetCachedBufferParams(length, duration, cur_pos))
     ret_val = now - duration;
 
   return ret_val;
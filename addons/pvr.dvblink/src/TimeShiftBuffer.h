@@ -29,6 +29,10 @@
 #include "platform/util/StdString.h"
 #include "libdvblinkremote/dvblinkremote.h"
 #include "platform/util/util.h"
+#include "platform/threads/threads.h"
+#include "platform/threads/mutex.h"
+
+#define DVBLINK_TIMESHIFT_STATS_INTERVAL  1000 // ms between two buffer statistics requests
 
 class LiveStreamerBase
 {
@@ -67,12 +71,15 @@ public:
 };
 
 
-class TimeShiftBuffer : public LiveStreamerBase
+class TimeShiftBuffer : public LiveStreamerBase, public PLATFORM::CThread
 {
 public:
   TimeShiftBuffer(ADDON::CHelper_libXBMC_addon * XBMC);
   ~TimeShiftBuffer(void);
 
+  virtual bool Start(std::string& streampath);
+  virtual void Stop();
+
   virtual long long Seek(long long iPosition, int iWhence);
   virtual long long Position();
   virtual long long Length();
@@ -85,10 +92,19 @@ public:
       bool use_transcoder, int width, int height, int bitrate, std::string audiotrack);
 
 protected:
+  virtual void * Process(void);
+
   bool ExecuteServerRequest(const std::string& url, std::vector<std::string>& response_values);
   bool GetBufferParams(long long& length, time_t& duration, long long& cur_pos);
-
-  time_t last_pos_req_time_;
-  time_t last_pos_;
+  void UpdateBufferParams();
+  bool GetCachedBufferParams(long long& length, time_t& duration, long long& cur_pos);
+
+  //buffer statistics, refreshed by the polling thread while streaming
+  PLATFORM::CMutex stats_mutex_;
+  PLATFORM::CEvent stop_event_;
+  bool stats_valid_;
+  long long stats_length_;
+  time_t stats_duration_;
+  long long stats_cur_pos_;
+  unsigned int stats_generation_; //bumped by a seek, older statistics are dropped
 };
-
@@ -0,0 +1,258 @@
+/*
+ *      Copyright (C) 2013 Anton Fedchin
+ *      http://github.com/afedchin/xbmc-addon-iptvsimple/
+ *
+ *      Copyright (C) 2011 Pulse-Eight
+ *      http://www.pulse-eight.com/
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1301  USA
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <string.h>
+#include "EpgSnapshotFile.h"
+#include "StringPool.h"
+#include "client.h"
+
+#define SNAPSHOT_BUFFER_SIZE    65536
+
+using namespace ADDON;
+
+EpgSnapshotFile::EpgSnapshotFile(void)
+{
+  m_fileHandle  = NULL;
+  m_bWrite      = false;
+  m_bError      = false;
+  m_iFileLength = 0;
+  m_iChecksum   = adler32(0L, Z_NULL, 0);
+  m_iPos        = 0;
+  m_iLength     = 0;
+}
+
+EpgSnapshotFile::~EpgSnapshotFile(void)
+{
+  Close();
+}
+
+bool EpgSnapshotFile::OpenForRead(const std::string &strPath)
+{
+  Close();
+
+  if ((m_fileHandle = XBMC->OpenFile(strPath.c_str(), 0)) == NULL)
+    return false;
+
+  m_bWrite      = false;
+  m_bError      = false;
+  m_iFileLength = XBMC->GetFileLength(m_fileHandle);
+  m_iChecksum   = adler32(0L, Z_NULL, 0);
+  m_iPos        = 0;
+  m_iLength     = 0;
+  m_buffer.resize(SNAPSHOT_BUFFER_SIZE);
+
+  return true;
+}
+
+bool EpgSnapshotFile::OpenForWrite(const std::string &strPath)
+{
+  Close();
+
+  if ((m_fileHandle = XBMC->OpenFileForWrite(strPath.c_str(), true)) == NULL)
+    return false;
+
+  m_bWrite      = true;
+  m_bError      = false;
+  m_iFileLength = 0;
+  m_iChecksum   = adler32(0L, Z_NULL, 0);
+  m_iPos        = 0;
+  m_iLength     = 0;
+  m_buffer.resize(SNAPSHOT_BUFFER_SIZE);
+
+  return true;
+}
+
+bool EpgSnapshotFile::Close(void)
+{
+  if (m_fileHandle == NULL)
+    return !m_bError;
+
+  if (m_bWrite)
+  {
+    uint32_t iChecksum = (uint32_t)m_iChecksum;
+    Write(&iChecksum, sizeof(iChecksum));
+    Flush();
+  }
+
+  XBMC->CloseFile(m_fileHandle);
+  m_fileHandle = NULL;
+  m_buffer.clear();
+  m_writtenStrings.clear();
+  m_readStrings.clear();
+
+  return !m_bError;
+}
+
+bool EpgSnapshotFile::Fill(void)
+{
+  if (m_bError || m_fileHandle == NULL)
+    return false;
+
+  int iRead = XBMC->ReadFile(m_fileHandle, &m_buffer[0], m_buffer.size());
+  if (iRead <= 0)
+  {
+    m_bError = true;
+    return false;
+  }
+
+  m_iPos = 0;
+  m_iLength = iRead;
+  return true;
+}
+
+bool EpgSnapshotFile::Flush(void)
+{
+  if (m_bError || m_fileHandle == NULL)
+    return false;
+
+  if (m_iLength > 0 && XBMC->WriteFile(m_fileHandle, &m_buffer[0], m_iLength) != (int)m_iLength)
+    m_bError = true;
+
+  m_iLength = 0;
+  return !m_bError;
+}
+
+bool EpgSnapshotFile::Read(void *data, size_t iLength)
+{
+  char *pData = (char *)data;
+  while (iLength > 0)
+  {
+    if (m_iPos == m_iLength && !Fill())
+      return false;
+
+    size_t iCopy = m_iLength - m_iPos;
+    if (iCopy > iLength)
+      iCopy = iLength;
+
+    memcpy(pData, &m_buffer[m_iPos], iCopy);
+    m_iChecksum = adler32(m_iChecksum, (const Bytef *)pData, iCopy);
+    m_iPos += iCopy;
+    pData += iCopy;
+    iLength -= iCopy;
+  }
+
+  return true;
+}
+
+bool EpgSnapshotFile::ReadString(std::string &strValue)
+{
+  uint32_t iLength;
+  if (!ReadValue(iLength))
+    return false;
+
+  // a corrupted length must not trigger a huge allocation
+  if (iLength > m_iFileLength)
+  {
+    m_bError = true;
+    return false;
+  }
+
+  strValue.resize(iLength);
+  return iLength == 0 || Read(&strValue[0], iLength);
+}
+
+bool EpgSnapshotFile::ReadPooledString(StringPool &strings, const char *&strValue)
+{
+  uint32_t iRef;
+  if (!ReadValue(iRef))
+    return false;
+
+  // 0 is followed by a string not read yet, else the number of a previous one
+  if (iRef == 0)
+  {
+    if (!ReadString(m_strRead))
+      return false;
+
+    strValue = strings.Intern(m_strRead);
+    m_readStrings.push_back(strValue);
+    return true;
+  }
+
+  if (iRef > m_readStrings.size())
+  {
+    m_bError = true;
+    return false;
+  }
+
+  strValue = m_readStrings[iRef - 1];
+  return true;
+}
+
+bool EpgSnapshotFile::ReadChecksum(void)
+{
+  uLong iExpected = m_iChecksum;
+  uint32_t iChecksum;
+  if (!Read(&iChecksum, sizeof(iChecksum)))
+    return false;
+
+  return iChecksum == (uint32_t)iExpected;
+}
+
+void EpgSnapshotFile::Write(const void *data, size_t iLength)
+{
+  if (m_bError)
+    return;
+
+  m_iChecksum = adler32(m_iChecksum, (const Bytef *)data, iLength);
+
+  const char *pData = (const char *)data;
+  while (iLength > 0)
+  {
+    if (m_iLength == m_buffer.size() && !Flush())
+      return;
+
+    size_t iCopy = m_buffer.size() - m_iLength;
+    if (iCopy > iLength)
+      iCopy = iLength;
+
+    memcpy(&m_buffer[m_iLength], pData, iCopy);
+    m_iLength += iCopy;
+    pData += iCopy;
+    iLength -= iCopy;
+  }
+}
+
+void EpgSnapshotFile::WriteString(const std::string &strValue)
+{
+  uint32_t iLength = strValue.length();
+  WriteValue(iLength);
+  Write(strValue.c_str(), iLength);
+}
+
+void EpgSnapshotFile::WritePooledString(const char *strValue)
+{
+  std::map<const char *, uint32_t>::iterator it = m_writtenStrings.find(strValue);
+  if (it != m_writtenStrings.end())
+  {
+    WriteValue(it->second);
+    return;
+  }
+
+  uint32_t iRef = m_writtenStrings.size() + 1;
+  m_writtenStrings.insert(std::make_pair(strValue, iRef));
+
+  WriteValue((uint32_t)0);
+  WriteString(strValue);
+}
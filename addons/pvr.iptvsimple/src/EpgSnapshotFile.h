@@ -0,0 +1,95 @@
+#pragma once
+/*
+ *      Copyright (C) 2013 Anton Fedchin
+ *      http://github.com/afedchin/xbmc-addon-iptvsimple/
+ *
+ *      Copyright (C) 2011 Pulse-Eight
+ *      http://www.pulse-eight.com/
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1301  USA
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <string>
+#include <vector>
+#include <map>
+#include <stdint.h>
+#include "zlib.h"
+
+class StringPool;
+
+/*!
+ * @brief Buffered binary file used for the parsed EPG snapshot.
+ * Values are stored in native byte order, the file is a local cache only.
+ * An adler32 checksum of everything written is appended on Close() and
+ * checked by ReadChecksum() when reading.
+ */
+class EpgSnapshotFile
+{
+public:
+  EpgSnapshotFile(void);
+  virtual ~EpgSnapshotFile(void);
+
+  bool OpenForRead(const std::string &strPath);
+  bool OpenForWrite(const std::string &strPath);
+
+  /*!
+   * @brief Close the file. A file opened for writing gets its checksum appended.
+   * @return False if any read or write failed.
+   */
+  bool Close(void);
+
+  bool Read(void *data, size_t iLength);
+  bool ReadString(std::string &strValue);
+  template<class T> bool ReadValue(T &value) { return Read(&value, sizeof(T)); }
+
+  /*!
+   * @brief Read a string written by WritePooledString() and add it to a pool.
+   */
+  bool ReadPooledString(StringPool &strings, const char *&strValue);
+
+  /*!
+   * @brief Read the checksum stored at the end of the file and compare it with the data read so far.
+   */
+  bool ReadChecksum(void);
+
+  void Write(const void *data, size_t iLength);
+  void WriteString(const std::string &strValue);
+  template<class T> void WriteValue(const T &value) { Write(&value, sizeof(T)); }
+
+  /*!
+   * @brief Write a string of a StringPool, a string written before is only referenced.
+   */
+  void WritePooledString(const char *strValue);
+
+private:
+  bool Fill(void);
+  bool Flush(void);
+
+  void              *m_fileHandle;
+  bool               m_bWrite;
+  bool               m_bError;
+  int64_t            m_iFileLength;
+  uLong              m_iChecksum;
+  std::vector<char>  m_buffer;
+  size_t             m_iPos;
+  size_t             m_iLength;
+
+  std::map<const char *, uint32_t> m_writtenStrings;
+  std::vector<const char *>        m_readStrings;
+  std::string                      m_strRead;
+};
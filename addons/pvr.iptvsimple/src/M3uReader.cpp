@@ -0,0 +1,158 @@
+/*
+ *      Copyright (C) 2013 Anton Fedchin
+ *      http://github.com/afedchin/xbmc-addon-iptvsimple/
+ *
+ *      Copyright (C) 2011 Pulse-Eight
+ *      http://www.pulse-eight.com/
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1301  USA
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <string.h>
+#include "M3uReader.h"
+#include "client.h"
+
+#define M3U_READ_CHUNK_SIZE     65536
+
+using namespace ADDON;
+
+M3uReader::M3uReader(void)
+{
+  m_fileHandle = NULL;
+  m_copyHandle = NULL;
+  m_bEof       = true;
+  m_iPos       = 0;
+  m_iLength    = 0;
+}
+
+M3uReader::~M3uReader(void)
+{
+  Close();
+}
+
+bool M3uReader::Open(const std::string &strPath, const std::string &strCopyPath)
+{
+  Close();
+
+  m_fileHandle = XBMC->OpenFile(strPath.c_str(), 0);
+  if (!m_fileHandle)
+    return false;
+
+  m_buffer.resize(M3U_READ_CHUNK_SIZE);
+  m_bEof = false;
+  if (!Fill())
+  {
+    Close();
+    return false;
+  }
+
+  if (!strCopyPath.empty())
+  {
+    m_copyHandle = XBMC->OpenFileForWrite(strCopyPath.c_str(), true);
+    if (m_copyHandle)
+      XBMC->WriteFile(m_copyHandle, &m_buffer[0], m_iLength);
+  }
+
+  return true;
+}
+
+void M3uReader::Close(void)
+{
+  if (m_fileHandle)
+  {
+    XBMC->CloseFile(m_fileHandle);
+    m_fileHandle = NULL;
+  }
+  if (m_copyHandle)
+  {
+    XBMC->CloseFile(m_copyHandle);
+    m_copyHandle = NULL;
+  }
+
+  m_bEof    = true;
+  m_iPos    = 0;
+  m_iLength = 0;
+  m_buffer.clear();
+}
+
+char *M3uReader::NextLine(size_t &iLength)
+{
+  while (true)
+  {
+    char *pStart = &m_buffer[0] + m_iPos;
+    char *pNewLine = (char *)memchr(pStart, '\n', m_iLength - m_iPos);
+    if (pNewLine == NULL)
+    {
+      if (Fill())
+        continue;
+
+      // the last line has no line break, Fill() may have moved it
+      if (m_iPos == m_iLength)
+        return NULL;
+      pStart = &m_buffer[0] + m_iPos;
+    }
+
+    char *pEnd = pNewLine != NULL ? pNewLine : &m_buffer[0] + m_iLength;
+
+    m_iPos = (pNewLine != NULL ? pNewLine + 1 : pEnd) - &m_buffer[0];
+
+    while (pStart < pEnd && (*pStart == ' ' || *pStart == '\t'))
+      pStart++;
+    while (pEnd > pStart && (pEnd[-1] == ' ' || pEnd[-1] == '\t' || pEnd[-1] == '\r'))
+      pEnd--;
+
+    if (pStart == pEnd)
+      continue;
+
+    // Fill() always leaves room for this after the data
+    *pEnd = '\0';
+    iLength = pEnd - pStart;
+    return pStart;
+  }
+}
+
+bool M3uReader::Fill(void)
+{
+  if (m_bEof)
+    return false;
+
+  // drop the lines already returned
+  if (m_iPos > 0)
+  {
+    memmove(&m_buffer[0], &m_buffer[0] + m_iPos, m_iLength - m_iPos);
+    m_iLength -= m_iPos;
+    m_iPos = 0;
+  }
+
+  // the current line doesn't fit
+  if (m_iLength + 1 >= m_buffer.size())
+    m_buffer.resize(m_buffer.size() * 2);
+
+  unsigned int iRead = XBMC->ReadFile(m_fileHandle, &m_buffer[0] + m_iLength, m_buffer.size() - m_iLength - 1);
+  if (iRead == 0)
+  {
+    m_bEof = true;
+    return false;
+  }
+
+  if (m_copyHandle)
+    XBMC->WriteFile(m_copyHandle, &m_buffer[0] + m_iLength, iRead);
+
+  m_iLength += iRead;
+  return true;
+}
@@ -0,0 +1,66 @@
+#pragma once
+/*
+ *      Copyright (C) 2013 Anton Fedchin
+ *      http://github.com/afedchin/xbmc-addon-iptvsimple/
+ *
+ *      Copyright (C) 2011 Pulse-Eight
+ *      http://www.pulse-eight.com/
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1301  USA
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <string>
+#include <vector>
+
+/*!
+ * @brief Line reader for M3U playlists.
+ * The file is read in chunks and lines are returned in place from the read
+ * buffer, which grows when a line doesn't fit in it.
+ */
+class M3uReader
+{
+public:
+  M3uReader(void);
+  virtual ~M3uReader(void);
+
+  /*!
+   * @brief Open a playlist file.
+   * @param strPath The file to read.
+   * @param strCopyPath If not empty, raw file contents are copied to this file while reading.
+   * @return False if the file can't be opened or is empty.
+   */
+  bool Open(const std::string &strPath, const std::string &strCopyPath = "");
+  void Close(void);
+
+  /*!
+   * @brief Get the next non empty line, without leading and trailing blanks.
+   * @param iLength Set to the length of the line.
+   * @return The zero terminated line, valid until the next call, or NULL at the end of file.
+   */
+  char *NextLine(size_t &iLength);
+
+private:
+  bool Fill(void);
+
+  void              *m_fileHandle;
+  void              *m_copyHandle;
+  bool               m_bEof;
+  std::vector<char>  m_buffer;
+  size_t             m_iPos;
+  size_t             m_iLength;
+};
@@ -23,13 +23,14 @@
  *
  */
 
-#include <sstream>
 #include <string>
-#include <fstream>
 #include <map>
-#include "zlib.h"
+#include <algorithm>
 #include "rapidxml/rapidxml.hpp"
 #include "PVRIptvData.h"
+#include "XmltvReader.h"
+#include "EpgSnapshotFile.h"
+#include "M3uReader.h"
 
 #define M3U_START_MARKER        "#EXTM3U"
 #define M3U_INFO_MARKER         "#EXTINF"
@@ -41,10 +42,80 @@
 #define RADIO_MARKER            "radio="
 #define CHANNEL_LOGO_EXTENSION  ".png"
 #define SECONDS_IN_DAY          86400
+#define EPG_SNAPSHOT_MAGIC      0x47455049 // "IPEG"
+#define EPG_SNAPSHOT_VERSION    5
+#define EPG_CHECK_INTERVAL      900   // seconds between checks for a changed guide
+#define EPG_REFRESH_INTERVAL    21600 // reload period for guides that can't be checked
+#define SOURCES_SEPARATOR       ';'
 
 using namespace std;
 using namespace ADDON;
 using namespace rapidxml;
+using namespace PLATFORM;
+
+/* key="value" or key=value attribute of a M3U line, pointing into the line */
+struct M3uAttribute
+{
+  const char *pKey;
+  size_t      iKeyLen;
+  const char *pValue;
+  size_t      iValueLen;
+
+  M3uAttribute() : pKey(NULL), iKeyLen(0), pValue(""), iValueLen(0) {}
+};
+
+inline bool NextM3uAttribute(const char *&pPos, const char *pEnd, M3uAttribute &attribute)
+{
+  while (pPos < pEnd)
+  {
+    while (pPos < pEnd && (*pPos == ' ' || *pPos == '\t'))
+      pPos++;
+
+    const char *pToken = pPos;
+    while (pPos < pEnd && *pPos != '=' && *pPos != ' ' && *pPos != '\t')
+      pPos++;
+    if (pPos == pEnd || *pPos != '=')
+      continue;
+
+    attribute.pKey = pToken;
+    attribute.iKeyLen = pPos - pToken;
+    pPos++;
+
+    char cEnd = ' ';
+    if (pPos < pEnd && *pPos == '"')
+    {
+      cEnd = '"';
+      pPos++;
+    }
+    attribute.pValue = pPos;
+    while (pPos < pEnd && *pPos != cEnd)
+      pPos++;
+    attribute.iValueLen = pPos - attribute.pValue;
+    if (pPos < pEnd)
+      pPos++;
+
+    return true;
+  }
+
+  return false;
+}
+
+/* strMarker includes the trailing '=' which follows the key in the line */
+inline bool IsM3uAttribute(const M3uAttribute &attribute, const char *strMarker)
+{
+  return strlen(strMarker) == attribute.iKeyLen + 1 && strncmp(attribute.pKey, strMarker, attribute.iKeyLen + 1) == 0;
+}
+
+inline std::string ToUTF8(const std::string &strText)
+{
+  char *strUTF8 = XBMC->UnknownToUTF8(strText.c_str());
+  if (strUTF8 == NULL)
+    return strText;
+
+  std::string strResult = strUTF8;
+  XBMC->FreeString(strUTF8);
+  return strResult;
+}
 
 template<class Ch>
 inline bool GetNodeValue(const xml_node<Ch> * pRootNode, const char* strTag, CStdString& strStringValue)
@@ -58,6 +129,17 @@ inline bool GetNodeValue(const xml_node<Ch> * pRootNode, const char* strTag, CSt
   return true;
 }
 
+template<class Ch>
+inline const char *GetNodeString(const xml_node<Ch> * pRootNode, const char* strTag, StringPool &strings)
+{
+  xml_node<Ch> *pChildNode = pRootNode->first_node(strTag);
+  if (pChildNode == NULL)
+  {
+    return "";
+  }
+  return strings.Intern(pChildNode->value(), pChildNode->value_size());
+}
+
 template<class Ch>
 inline bool GetAttributeValue(const xml_node<Ch> * pNode, const char* strAttributeName, CStdString& strStringValue)
 {
@@ -70,6 +152,117 @@ inline bool GetAttributeValue(const xml_node<Ch> * pNode, const char* strAttribu
   return true;
 }
 
+// returns whichever comes first in items: pFound or the item indexed by strKey
+template<class T>
+inline T *FirstMatch(std::vector<T> &items, const std::map<std::string, int> &index, const std::string &strKey, T *pFound)
+{
+  std::map<std::string, int>::const_iterator it = index.find(strKey);
+  if (it == index.end() || (pFound != NULL && pFound <= &items[it->second]))
+  {
+    return pFound;
+  }
+  return &items[it->second];
+}
+
+inline bool EpgEntryStartsBefore(const PVRIptvEpgEntry &left, const PVRIptvEpgEntry &right)
+{
+  return left.startTime < right.startTime;
+}
+
+inline bool EpgEntryStartsBeforeTime(const PVRIptvEpgEntry &entry, time_t iTime)
+{
+  return entry.startTime < iTime;
+}
+
+// days since 1970-01-01 of a proleptic Gregorian date
+inline int DaysFromCivil(int iYear, int iMonth, int iDay)
+{
+  iYear -= iMonth <= 2;
+  int iEra = (iYear >= 0 ? iYear : iYear - 399) / 400;
+  int iYearOfEra = iYear - iEra * 400;
+  int iDayOfYear = (153 * (iMonth + (iMonth > 2 ? -3 : 9)) + 2) / 5 + iDay - 1;
+  int iDayOfEra = iYearOfEra * 365 + iYearOfEra / 4 - iYearOfEra / 100 + iDayOfYear;
+  return iEra * 146097 + iDayOfEra - 719468;
+}
+
+// splits a ';' separated list of playlist or guide locations
+inline std::vector<std::string> SplitSources(const std::string &strSources)
+{
+  std::vector<std::string> sources;
+  size_t iStart = 0;
+  while (iStart <= strSources.length())
+  {
+    size_t iEnd = strSources.find(SOURCES_SEPARATOR, iStart);
+    if (iEnd == std::string::npos)
+      iEnd = strSources.length();
+
+    CStdString strSource = strSources.substr(iStart, iEnd - iStart);
+    strSource.Trim();
+    if (!strSource.IsEmpty())
+      sources.push_back(strSource);
+
+    iStart = iEnd + 1;
+  }
+  return sources;
+}
+
+// the first source keeps the plain cache name used by earlier versions
+inline std::string GetSourceCacheName(const char *strName, int iSource)
+{
+  if (iSource == 0)
+    return strName;
+
+  char buff[16];
+  sprintf(buff, ".%d", iSource);
+  return std::string(strName) + buff;
+}
+
+// modification time and size of every source, false if one of them can't be checked for changes
+inline bool StatSources(const std::vector<std::string> &sources, std::vector<int64_t> &sourceStats)
+{
+  sourceStats.clear();
+  for (unsigned int iSource = 0; iSource < sources.size(); iSource++)
+  {
+    struct __stat64 statOrig;
+    memset(&statOrig, 0, sizeof(statOrig));
+    XBMC->StatFile(sources[iSource].c_str(), &statOrig);
+    if (statOrig.st_mtime == 0)
+      return false;
+
+    sourceStats.push_back((int64_t)statOrig.st_mtime);
+    sourceStats.push_back((int64_t)statOrig.st_size);
+  }
+  return !sources.empty();
+}
+
+inline uint32_t HashString(uint32_t iHash, const std::string &strValue)
+{
+  // include the terminating zero so that consecutive strings can't run together
+  return crc32(iHash, (const Bytef *)strValue.c_str(), strValue.length() + 1);
+}
+
+PVRIptvSourceLoader::PVRIptvSourceLoader(PVRIptvData *data, int iSource, const std::string &strPath, bool bPlayList)
+{
+  m_data      = data;
+  m_iSource   = iSource;
+  m_strPath   = strPath;
+  m_bPlayList = bPlayList;
+  m_bLoaded   = false;
+
+  m_guide.bReadError = false;
+}
+
+void *PVRIptvSourceLoader::Process(void)
+{
+  if (m_bPlayList)
+    m_bLoaded = m_data->LoadPlayListSource(m_iSource, m_strPath, m_playList);
+  else
+    m_bLoaded = m_data->LoadEPGSource(m_iSource, m_strPath, m_guide);
+
+  m_finished.Signal();
+  return NULL;
+}
+
 PVRIptvData::PVRIptvData(void)
 {
   m_strXMLTVUrl   = g_strTvgPath;
@@ -77,8 +270,7 @@ PVRIptvData::PVRIptvData(void)
   m_strLogoPath   = g_strLogoPath;
   m_iEPGTimeShift = g_iEPGTimeShift;
   m_bTSOverride   = g_bTSOverride;
-  m_iLastStart    = 0;
-  m_iLastEnd      = 0;
+  m_iEPGLoadTime  = 0;
 
   m_bEGPLoaded = false;
 
@@ -86,255 +278,430 @@ PVRIptvData::PVRIptvData(void)
   {
     XBMC->QueueNotification(QUEUE_INFO, "%d channels loaded.", m_channels.size());
   }
+
+  // refreshes the guide in the background once it has been loaded, wait
+  // for it to start so that StopThread() in the destructor can't miss it
+  CreateThread(true);
 }
 
 void *PVRIptvData::Process(void)
 {
+  time_t iLastCheck = time(NULL);
+  while (!IsStopped())
+  {
+    Sleep(1000);
+
+    if (IsStopped() || time(NULL) - iLastCheck < EPG_CHECK_INTERVAL)
+      continue;
+    iLastCheck = time(NULL);
+
+    CLockObject lock(m_loadMutex);
+    if (!m_bEGPLoaded || !IsEPGOutdated())
+      continue;
+
+    XBMC->Log(LOG_NOTICE, "EPG source has changed, reloading.");
+    if (LoadEPG())
+    {
+      for (unsigned int iChannelPtr = 0, max = m_channels.size(); iChannelPtr < max; iChannelPtr++)
+      {
+        PVR->TriggerEpgUpdate(m_channels.at(iChannelPtr).iUniqueId);
+      }
+    }
+  }
+
   return NULL;
 }
 
 PVRIptvData::~PVRIptvData(void)
 {
+  StopThread(0);
+
   m_channels.clear();
   m_groups.clear();
-  m_epg.clear();
 }
 
-bool PVRIptvData::LoadEPG(time_t iStart, time_t iEnd) 
+void PVRIptvData::RunLoaders(std::vector<PVRIptvSourceLoader *> &loaders)
 {
-  if (m_strXMLTVUrl.IsEmpty())
+  // a single source is loaded on the calling thread
+  if (loaders.size() == 1)
   {
-    XBMC->Log(LOG_NOTICE, "EPG file path is not configured. EPG not loaded.");
-    m_bEGPLoaded = true;
-    return false;
+    loaders[0]->Process();
+    return;
   }
 
-  std::string data;
-  std::string decompressed;
-  int iReaded = 0;
-
-  int iCount = 0;
-  while(iCount < 3) // max 3 tries
+  for (unsigned int iLoader = 0; iLoader < loaders.size(); iLoader++)
   {
-    if ((iReaded = GetCachedFileContents(TVG_FILE_NAME, m_strXMLTVUrl, data, g_bCacheEPG)) != 0) 
+    if (!loaders[iLoader]->CreateThread(false))
     {
-      break;
-    }
-    XBMC->Log(LOG_ERROR, "Unable to load EPG file '%s':  file is missing or empty. :%dth try.", m_strXMLTVUrl.c_str(), ++iCount);
-    if (iCount < 3)
-    {
-      usleep(2 * 1000 * 1000); // sleep 2 sec before next try.
+      loaders[iLoader]->Process();
     }
   }
-  
-  if (iReaded == 0)
+
+  // CThread::IsRunning() can't tell a finished thread from one not yet started
+  for (unsigned int iLoader = 0; iLoader < loaders.size(); iLoader++)
+  {
+    loaders[iLoader]->WaitFinished();
+  }
+}
+
+bool PVRIptvData::LoadEPG(void) 
+{
+  CLockObject loadLock(m_loadMutex);
+
+  std::vector<std::string> sources = SplitSources(m_strXMLTVUrl);
+  if (sources.empty())
   {
-    XBMC->Log(LOG_ERROR, "Unable to load EPG file '%s':  file is missing or empty. After %d tries.", m_strXMLTVUrl.c_str(), iCount);
+    XBMC->Log(LOG_NOTICE, "EPG file path is not configured. EPG not loaded.");
     m_bEGPLoaded = true;
-    m_iLastStart = iStart;
-    m_iLastEnd = iEnd;
     return false;
   }
 
-  char * buffer;
+  // taken before reading, so that a change made meanwhile triggers the next refresh
+  std::vector<int64_t> sourceStats;
+  StatSources(sources, sourceStats);
+  time_t iLoadTime = time(NULL);
 
-  // gzip packed
-  if (data[0] == '\x1F' && data[1] == '\x8B' && data[2] == '\x08') 
+  PVRIptvEpg epg;
+  if (g_bCacheEPG && LoadEPGSnapshot(epg))
   {
-    if (!GzipInflate(data, decompressed))
-    {
-      XBMC->Log(LOG_ERROR, "Invalid EPG file '%s': unable to decompress file.", m_strXMLTVUrl.c_str());
-      m_bEGPLoaded = true;
-      return false;
-    }
-    buffer = &(decompressed[0]);
+    XBMC->Log(LOG_NOTICE, "EPG Loaded from snapshot.");
   }
   else
   {
-    buffer = &(data[0]);
-  }
+    std::vector<PVRIptvSourceLoader *> loaders;
+    for (unsigned int iSource = 0; iSource < sources.size(); iSource++)
+    {
+      loaders.push_back(new PVRIptvSourceLoader(this, iSource, sources[iSource], false));
+    }
+    RunLoaders(loaders);
 
-  // xml should starts with '<?xml'
-  if (buffer[0] != '\x3C' || buffer[1] != '\x3F' || buffer[2] != '\x78' ||
-      buffer[3] != '\x6D' || buffer[4] != '\x6C')
-  {
-    // check for BOM
-    if (buffer[0] != '\xEF' || buffer[1] != '\xBB' || buffer[2] != '\xBF')
+    // merge in source order, a channel already provided by an earlier source is skipped
+    bool bComplete = !IsStopped();
+    std::map<std::string, int> epgIds;
+    for (unsigned int iSource = 0; iSource < loaders.size(); iSource++)
     {
-      // check for tar archive
-      if (strcmp(buffer + 0x101, "ustar") || strcmp(buffer + 0x101, "GNUtar"))
+      PVRIptvGuide &guide = loaders[iSource]->m_guide;
+      bComplete &= loaders[iSource]->m_bLoaded && !guide.bReadError;
+      if (!loaders[iSource]->m_bLoaded)
       {
-        buffer += 0x200; // RECORDSIZE = 512
+        continue;
       }
-      else
+
+      vector<PVRIptvEpgChannel>::iterator it;
+      for (it = guide.epg.begin(); it < guide.epg.end(); it++)
       {
-        XBMC->Log(LOG_ERROR, "Invalid EPG file '%s': unable to parse file.", m_strXMLTVUrl.c_str());
-        m_bEGPLoaded = true;
-        return false;
+        if (!epgIds.insert(std::make_pair(it->strId, (int)epg.channels.size())).second)
+        {
+          continue;
+        }
+
+        epg.channels.push_back(PVRIptvEpgChannel());
+        epg.channels.back().strId.swap(it->strId);
+        epg.channels.back().strName.swap(it->strName);
+        epg.channels.back().epg.swap(it->epg);
       }
+      epg.strings.Adopt(guide.strings);
     }
-  }
 
-  xml_document<> xmlDoc;
-  try 
-  {
-    xmlDoc.parse<0>(buffer);
-  } 
-  catch(parse_error p) 
-  {
-    XBMC->Log(LOG_ERROR, "Unable parse EPG XML: %s", p.what());
-    m_bEGPLoaded = true;
-    return false;
+    for (unsigned int iSource = 0; iSource < loaders.size(); iSource++)
+    {
+      delete loaders[iSource];
+    }
+
+    if (IsStopped())
+    {
+      return false;
+    }
+
+    // keep the current guide when nothing could be read
+    if (epg.channels.size() == 0) 
+    {
+      XBMC->Log(LOG_ERROR, "EPG channels not found.");
+      m_bEGPLoaded = true;
+      m_iEPGLoadTime = iLoadTime;
+      m_epgSourceStats = sourceStats;
+      return false;
+    }
+
+    SortEpg(epg.channels);
+
+    if (g_bCacheEPG && bComplete)
+    {
+      SaveEPGSnapshot(epg.channels);
+    }
+
+    XBMC->Log(LOG_NOTICE, "EPG Loaded.");
   }
 
-  xml_node<> *pRootElement = xmlDoc.first_node("tv");
-  if (!pRootElement)
+  // readers are only held up while the containers are swapped, the
+  // previous guide is released after the lock
+  IndexEpg(epg);
   {
-    XBMC->Log(LOG_ERROR, "Invalid EPG XML: no <tv> tag found");
+    CLockObject lock(m_epgMutex);
+    m_epg.channels.swap(epg.channels);
+    m_epg.idIndex.swap(epg.idIndex);
+    m_epg.nameIndex.swap(epg.nameIndex);
+    m_epg.tvgNameIndex.swap(epg.tvgNameIndex);
+    m_epg.strings.Swap(epg.strings);
     m_bEGPLoaded = true;
-    return false;
   }
 
-  // clear previously loaded epg
-  if (m_epg.size() > 0) 
+  m_iEPGLoadTime = iLoadTime;
+  m_epgSourceStats = sourceStats;
+
+  return true;
+}
+
+bool PVRIptvData::IsEPGOutdated(void)
+{
+  std::vector<int64_t> sourceStats;
+  if (StatSources(SplitSources(m_strXMLTVUrl), sourceStats))
+    return sourceStats != m_epgSourceStats;
+
+  // sources without a modification time are reloaded periodically
+  return time(NULL) - m_iEPGLoadTime >= EPG_REFRESH_INTERVAL;
+}
+
+bool PVRIptvData::LoadEPGSource(int iSource, const std::string &strPath, PVRIptvGuide &guide)
+{
+  // read the cached copy when it is up to date, else refresh it while reading
+  std::string strCachedPath = GetUserFilePath(GetSourceCacheName(TVG_FILE_NAME, iSource));
+  std::string strReadPath = strPath;
+  std::string strCopyPath = "";
+  if (g_bCacheEPG)
   {
-    m_epg.clear();
+    if (IsCacheUpToDate(strCachedPath, strPath))
+      strReadPath = strCachedPath;
+    else
+      strCopyPath = strCachedPath;
   }
 
-  int iBroadCastId = 0;
-  xml_node<> *pChannelNode = NULL;
-  for(pChannelNode = pRootElement->first_node("channel"); pChannelNode; pChannelNode = pChannelNode->next_sibling("channel"))
+  XmltvReader reader;
+  bool bOpened = false;
+
+  int iCount = 0;
+  while(iCount < 3) // max 3 tries
   {
-    CStdString strName;
-    CStdString strId;
-    if(!GetAttributeValue(pChannelNode, "id", strId))
+    if ((bOpened = reader.Open(strReadPath, strCopyPath))) 
     {
-      continue;
+      break;
     }
-    GetNodeValue(pChannelNode, "display-name", strName);
-
-    if (FindChannel(strId, strName) == NULL)
+    XBMC->Log(LOG_ERROR, "Unable to load EPG file '%s':  file is missing or empty. :%dth try.", strPath.c_str(), ++iCount);
+    if (iCount < 3)
     {
-      continue;
+      usleep(2 * 1000 * 1000); // sleep 2 sec before next try.
     }
-
-    PVRIptvEpgChannel epgChannel;
-    epgChannel.strId = strId;
-    epgChannel.strName = strName;
-
-    m_epg.push_back(epgChannel);
   }
-
-  if (m_epg.size() == 0) 
+  
+  if (!bOpened)
   {
-    XBMC->Log(LOG_ERROR, "EPG channels not found.");
+    XBMC->Log(LOG_ERROR, "Unable to load EPG file '%s':  file is missing or empty. After %d tries.", strPath.c_str(), iCount);
     return false;
   }
-  
-  int iMinShiftTime = m_iEPGTimeShift;
-  int iMaxShiftTime = m_iEPGTimeShift;
-  if (!m_bTSOverride)
-  {
-    iMinShiftTime = SECONDS_IN_DAY;
-    iMaxShiftTime = -SECONDS_IN_DAY;
 
-    vector<PVRIptvChannel>::iterator it;
-    for (it = m_channels.begin(); it < m_channels.end(); it++)
+  // XMLTV lists all <channel> elements before the <programme> ones, so
+  // elements are handled in a single pass as they are read
+  int iBroadCastId = 0;
+  std::map<std::string, int> epgIndexes;
+  PVRIptvEpgChannel *epg = NULL;
+  xml_node<> *pChannelNode = NULL;
+  while (!IsStopped() && (pChannelNode = reader.NextElement()) != NULL)
+  {
+    if (strcmp(pChannelNode->name(), "channel") == 0)
     {
-      if (it->iTvgShift + m_iEPGTimeShift < iMinShiftTime)
-        iMinShiftTime = it->iTvgShift + m_iEPGTimeShift;
-      if (it->iTvgShift + m_iEPGTimeShift > iMaxShiftTime)
-        iMaxShiftTime = it->iTvgShift + m_iEPGTimeShift;
+      CStdString strName;
+      CStdString strId;
+      if(!GetAttributeValue(pChannelNode, "id", strId))
+      {
+        continue;
+      }
+      GetNodeValue(pChannelNode, "display-name", strName);
+
+      if (FindChannel(strId, strName) == NULL)
+      {
+        continue;
+      }
+
+      PVRIptvEpgChannel epgChannel;
+      epgChannel.strId = strId;
+      epgChannel.strName = strName;
+
+      guide.epg.push_back(epgChannel);
+      epgIndexes.insert(std::make_pair(epgChannel.strId, (int)guide.epg.size() - 1));
+      epg = NULL;
+      continue;
     }
-  }
 
-  CStdString strEmpty = "";
-  PVRIptvEpgChannel *epg = NULL;
-  for(pChannelNode = pRootElement->first_node("programme"); pChannelNode; pChannelNode = pChannelNode->next_sibling("programme"))
-  {
     CStdString strId;
     if (!GetAttributeValue(pChannelNode, "channel", strId))
       continue;
 
     if (epg == NULL || epg->strId != strId) 
     {
-      if ((epg = FindEpg(strId)) == NULL) 
+      std::map<std::string, int>::iterator it = epgIndexes.find(strId);
+      if (it == epgIndexes.end()) 
         continue;
+      epg = &guide.epg.at(it->second);
     }
 
-    CStdString strStart;
-    CStdString strStop;
+    xml_attribute<> *pStart = pChannelNode->first_attribute("start");
+    xml_attribute<> *pStop = pChannelNode->first_attribute("stop");
 
-    if (!GetAttributeValue(pChannelNode, "start", strStart) || !GetAttributeValue(pChannelNode, "stop", strStop)) 
+    if (pStart == NULL || pStop == NULL) 
     {
       continue;
     }
 
-    int iTmpStart = ParseDateTime(strStart);
-    int iTmpEnd = ParseDateTime(strStop);
-
-    if ((iTmpEnd + iMaxShiftTime < iStart) || (iTmpStart + iMinShiftTime > iEnd))
-    {
-      continue;
-    }
-
-    CStdString strTitle;
-    CStdString strCategory;
-    CStdString strDesc;
-
-    GetNodeValue(pChannelNode, "title", strTitle);
-    GetNodeValue(pChannelNode, "category", strCategory);
-    GetNodeValue(pChannelNode, "desc", strDesc);
+    time_t iTmpStart = ParseXmltvDateTime(pStart->value());
+    time_t iTmpEnd = ParseXmltvDateTime(pStop->value());
 
-    CStdString strIconPath;
+    const char *strIconPath = "";
     xml_node<> *pIconNode = pChannelNode->first_node("icon");
     if (pIconNode != NULL)
     {
-      if (!GetAttributeValue(pIconNode, "src", strIconPath)) 
+      xml_attribute<> *pIconSrc = pIconNode->first_attribute("src");
+      if (pIconSrc != NULL)
       {
-        strIconPath = "";
+        strIconPath = guide.strings.Intern(pIconSrc->value(), pIconSrc->value_size());
       }
     }
 
     PVRIptvEpgEntry entry;
     entry.iBroadcastId    = ++iBroadCastId;
+    entry.iChannelId      = 0;
     entry.iGenreType      = 0;
     entry.iGenreSubType   = 0;
-    entry.strTitle        = strTitle;
-    entry.strPlot         = strDesc;
+    entry.strTitle        = GetNodeString(pChannelNode, "title", guide.strings);
+    entry.strPlot         = GetNodeString(pChannelNode, "desc", guide.strings);
     entry.strPlotOutline  = "";
     entry.strIconPath     = strIconPath;
     entry.startTime       = iTmpStart;
     entry.endTime         = iTmpEnd;
-    entry.strGenreString  = strCategory;
+    entry.strGenreString  = GetNodeString(pChannelNode, "category", guide.strings);
 
     epg->epg.push_back(entry);
   }
 
-  xmlDoc.clear();
-  m_bEGPLoaded = true;
+  bool bStopped = IsStopped();
+  guide.bReadError = reader.IsError();
+  reader.Close();
 
-  XBMC->Log(LOG_NOTICE, "EPG Loaded.");
+  if (guide.bReadError || bStopped)
+  {
+    if (guide.bReadError)
+      XBMC->Log(LOG_ERROR, "Invalid EPG file '%s': unable to read the whole file.", strPath.c_str());
+    // don't keep a truncated copy
+    if (!strCopyPath.empty())
+      XBMC->DeleteFile(strCopyPath.c_str());
+  }
 
-  return true;
+  return !bStopped;
 }
 
 bool PVRIptvData::LoadPlayList(void) 
 {
-  if (m_strM3uUrl.IsEmpty())
+  std::vector<std::string> sources = SplitSources(m_strM3uUrl);
+  if (sources.empty())
   {
     XBMC->Log(LOG_NOTICE, "Playlist file path is not configured. Channels not loaded.");
     return false;
   }
 
-  CStdString strPlaylistContent;
-  if (!GetCachedFileContents(M3U_FILE_NAME, m_strM3uUrl, strPlaylistContent, g_bCacheM3U))
+  std::vector<PVRIptvSourceLoader *> loaders;
+  for (unsigned int iSource = 0; iSource < sources.size(); iSource++)
   {
-    XBMC->Log(LOG_ERROR, "Unable to load playlist file '%s':  file is missing or empty.", m_strM3uUrl.c_str());
+    loaders.push_back(new PVRIptvSourceLoader(this, iSource, sources[iSource], true));
+  }
+  RunLoaders(loaders);
+
+  // merge in source order, a channel already listed by an earlier source is skipped
+  int iChannelNum = g_iStartNumber;
+  for (unsigned int iSource = 0; iSource < loaders.size(); iSource++)
+  {
+    PVRIptvPlayList &playList = loaders[iSource]->m_playList;
+    if (!loaders[iSource]->m_bLoaded)
+    {
+      continue;
+    }
+
+    int iFirstChannel = m_channels.size();
+    std::vector<int> channelIndexes(playList.channels.size(), -1);
+    for (unsigned int iChannel = 0; iChannel < playList.channels.size(); iChannel++)
+    {
+      PVRIptvChannel &channel = playList.channels.at(iChannel);
+      PVRIptvChannel *pExisting = FindChannelByUid(channel.iUniqueId);
+      if (pExisting != NULL && pExisting < &m_channels[0] + iFirstChannel)
+      {
+        continue;
+      }
+
+      channel.iChannelNumber = iChannelNum++;
+      m_channels.push_back(channel);
+      channelIndexes[iChannel] = m_channels.size() - 1;
+      IndexChannel(channelIndexes[iChannel]);
+    }
+
+    vector<PVRIptvChannelGroup>::iterator group;
+    for (group = playList.groups.begin(); group < playList.groups.end(); group++)
+    {
+      PVRIptvChannelGroup *pGroup;
+      if ((pGroup = FindGroup(group->strGroupName)) == NULL)
+      {
+        PVRIptvChannelGroup newGroup;
+        newGroup.strGroupName = group->strGroupName;
+        newGroup.iGroupId     = m_groups.size() + 1;
+        newGroup.bRadio       = group->bRadio;
+
+        m_groups.push_back(newGroup);
+        m_groupNameIndex.insert(std::make_pair(newGroup.strGroupName, (int)m_groups.size() - 1));
+        pGroup = &m_groups.back();
+      }
+
+      vector<int>::iterator member;
+      for (member = group->members.begin(); member < group->members.end(); member++)
+      {
+        if (channelIndexes.at(*member) >= 0)
+          pGroup->members.push_back(channelIndexes.at(*member));
+      }
+    }
+  }
+
+  for (unsigned int iSource = 0; iSource < loaders.size(); iSource++)
+  {
+    delete loaders[iSource];
+  }
+
+  if (m_channels.size() == 0)
+  {
+    XBMC->Log(LOG_ERROR, "Unable to load channels from '%s'.", m_strM3uUrl.c_str());
     return false;
   }
 
-  std::stringstream stream(strPlaylistContent);
+  ApplyChannelsLogos();
+
+  XBMC->Log(LOG_NOTICE, "Loaded %d channels.", m_channels.size());
+  return true;
+}
+
+bool PVRIptvData::LoadPlayListSource(int iSource, const std::string &strPath, PVRIptvPlayList &playList)
+{
+  std::string strCachedPath = GetUserFilePath(GetSourceCacheName(M3U_FILE_NAME, iSource));
+  std::string strReadPath = strPath;
+  std::string strCopyPath;
+  if (g_bCacheM3U)
+  {
+    if (IsCacheUpToDate(strCachedPath, strPath))
+      strReadPath = strCachedPath;
+    else
+      strCopyPath = strCachedPath;
+  }
+
+  M3uReader reader;
+  if (!reader.Open(strReadPath, strCopyPath))
+  {
+    XBMC->Log(LOG_ERROR, "Unable to load playlist file '%s':  file is missing or empty.", strPath.c_str());
+    return false;
+  }
 
   /* load channels */
   bool bFirst = true;
@@ -342,9 +709,10 @@ bool PVRIptvData::LoadPlayList(void)
   int iChannelIndex     = 0;
   int iUniqueGroupId    = 0;
   int iCurrentGroupId   = 0;
-  int iChannelNum       = g_iStartNumber;
   int iEPGTimeShift     = 0;
 
+  std::map<std::string, int> groupIds;
+
   PVRIptvChannel tmpChannel;
   tmpChannel.strTvgId       = "";
   tmpChannel.strChannelName = "";
@@ -352,31 +720,31 @@ bool PVRIptvData::LoadPlayList(void)
   tmpChannel.strTvgLogo     = "";
   tmpChannel.iTvgShift      = 0;
 
-  char szLine[1024];
-  while(stream.getline(szLine, 1024)) 
+  size_t iLength;
+  char *strLine;
+  while ((strLine = reader.NextLine(iLength)) != NULL)
   {
-  
-    CStdString strLine = "";
-    strLine.append(szLine);
-    strLine.TrimRight(" \t\r\n");
-    strLine.TrimLeft(" \t");
-
-    if (strLine.IsEmpty())
-    {
-      continue;
-    }
+    M3uAttribute attribute;
 
     if (bFirst) 
     {
       bFirst = false;
-      if (strLine.Left(3) == "\xEF\xBB\xBF")
+      if (strncmp(strLine, "\xEF\xBB\xBF", 3) == 0)
       {
-        strLine.Delete(0, 3);
+        strLine += 3;
+        iLength -= 3;
       }
-      if (strLine.Left((int)strlen(M3U_START_MARKER)) == M3U_START_MARKER) 
+      if (strncmp(strLine, M3U_START_MARKER, strlen(M3U_START_MARKER)) == 0) 
       {
-        double fTvgShift = atof(ReadMarkerValue(strLine, TVG_INFO_SHIFT_MARKER));
-        iEPGTimeShift = (int) (fTvgShift * 3600.0);
+        const char *pPos = strLine + strlen(M3U_START_MARKER);
+        while (NextM3uAttribute(pPos, strLine + iLength, attribute))
+        {
+          if (IsM3uAttribute(attribute, TVG_INFO_SHIFT_MARKER))
+          {
+            iEPGTimeShift = (int) (atof(attribute.pValue) * 3600.0);
+            break;
+          }
+        }
         continue;
       }
       else
@@ -385,53 +753,63 @@ bool PVRIptvData::LoadPlayList(void)
       }
     }
 
-    if (strLine.Left((int)strlen(M3U_INFO_MARKER)) == M3U_INFO_MARKER) 
+    if (strncmp(strLine, M3U_INFO_MARKER, strlen(M3U_INFO_MARKER)) == 0) 
     {
-      bool        bRadio       = false;
-      double      fTvgShift    = 0;
-      CStdString  strChnlName  = "";
-      CStdString  strTvgId     = "";
-      CStdString  strTvgName   = "";
-      CStdString  strTvgLogo   = "";
-      CStdString  strGroupName = "";
-      CStdString  strRadio     = "";
-
       // parse line
-      int iColon = (int)strLine.Find(':');
-      int iComma = (int)strLine.ReverseFind(',');
-      if (iColon >= 0 && iComma >= 0 && iComma > iColon) 
+      const char *pColon = strchr(strLine, ':');
+      const char *pComma = strrchr(strLine, ',');
+      if (pColon != NULL && pComma != NULL && pComma > pColon) 
       {
         // parse name
-        iComma++;
-        strChnlName = strLine.Right((int)strLine.size() - iComma).Trim();
-        tmpChannel.strChannelName = XBMC->UnknownToUTF8(strChnlName);
-
-        // parse info
-        CStdString strInfoLine = strLine.Mid(++iColon, --iComma - iColon);
-
-        strTvgId      = ReadMarkerValue(strInfoLine, TVG_INFO_ID_MARKER);
-        strTvgName    = ReadMarkerValue(strInfoLine, TVG_INFO_NAME_MARKER);
-        strTvgLogo    = ReadMarkerValue(strInfoLine, TVG_INFO_LOGO_MARKER);
-        strGroupName  = ReadMarkerValue(strInfoLine, GROUP_NAME_MARKER);
-        strRadio      = ReadMarkerValue(strInfoLine, RADIO_MARKER);
-        fTvgShift     = atof(ReadMarkerValue(strInfoLine, TVG_INFO_SHIFT_MARKER));
+        const char *pName = pComma + 1;
+        while (*pName == ' ' || *pName == '\t')
+          pName++;
+        std::string strChnlName = pName;
+        tmpChannel.strChannelName = ToUTF8(strChnlName);
+
+        // parse info, the first occurrence of an attribute wins
+        const char *pInfo = pColon + 1;
+        M3uAttribute tvgId, tvgName, tvgLogo, tvgShift, groupName, radio;
+        const char *pPos = pInfo;
+        while (NextM3uAttribute(pPos, pComma, attribute))
+        {
+          M3uAttribute *pTarget = NULL;
+          if (IsM3uAttribute(attribute, TVG_INFO_ID_MARKER))
+            pTarget = &tvgId;
+          else if (IsM3uAttribute(attribute, TVG_INFO_NAME_MARKER))
+            pTarget = &tvgName;
+          else if (IsM3uAttribute(attribute, TVG_INFO_LOGO_MARKER))
+            pTarget = &tvgLogo;
+          else if (IsM3uAttribute(attribute, TVG_INFO_SHIFT_MARKER))
+            pTarget = &tvgShift;
+          else if (IsM3uAttribute(attribute, GROUP_NAME_MARKER))
+            pTarget = &groupName;
+          else if (IsM3uAttribute(attribute, RADIO_MARKER))
+            pTarget = &radio;
+
+          if (pTarget != NULL && pTarget->pKey == NULL)
+            *pTarget = attribute;
+        }
 
-        if (strTvgId.IsEmpty())
+        std::string strTvgId(tvgId.pValue, tvgId.iValueLen);
+        if (strTvgId.empty())
         {
           char buff[255];
-          sprintf(buff, "%d", atoi(strInfoLine));
+          sprintf(buff, "%d", atoi(pInfo));
           strTvgId.append(buff);
         }
-        if (strTvgLogo.IsEmpty())
+
+        std::string strTvgLogo(tvgLogo.pValue, tvgLogo.iValueLen);
+        if (strTvgLogo.empty())
         {
           strTvgLogo = strChnlName;
         }
 
-        bRadio                = !strRadio.CompareNoCase("true");
+        bool bRadio           = radio.iValueLen == 4 && strnicmp(radio.pValue, "true", 4) == 0;
         tmpChannel.strTvgId   = strTvgId;
-        tmpChannel.strTvgName = XBMC->UnknownToUTF8(strTvgName);
-        tmpChannel.strTvgLogo = XBMC->UnknownToUTF8(strTvgLogo);
-        tmpChannel.iTvgShift  = (int)(fTvgShift * 3600.0);
+        tmpChannel.strTvgName = ToUTF8(std::string(tvgName.pValue, tvgName.iValueLen));
+        tmpChannel.strTvgLogo = ToUTF8(strTvgLogo);
+        tmpChannel.iTvgShift  = tvgShift.pKey != NULL ? (int)(atof(tvgShift.pValue) * 3600.0) : 0;
         tmpChannel.bRadio     = bRadio;
 
         if (tmpChannel.iTvgShift == 0 && iEPGTimeShift != 0)
@@ -439,24 +817,25 @@ bool PVRIptvData::LoadPlayList(void)
           tmpChannel.iTvgShift = iEPGTimeShift;
         }
 
-        if (!strGroupName.IsEmpty())
+        if (groupName.iValueLen > 0)
         {
-          strGroupName = XBMC->UnknownToUTF8(strGroupName);
+          std::string strGroupName = ToUTF8(std::string(groupName.pValue, groupName.iValueLen));
 
-          PVRIptvChannelGroup * pGroup;
-          if ((pGroup = FindGroup(strGroupName)) == NULL)
+          std::map<std::string, int>::iterator itGroup = groupIds.find(strGroupName);
+          if (itGroup == groupIds.end())
           {
             PVRIptvChannelGroup group;
             group.strGroupName = strGroupName;
             group.iGroupId = ++iUniqueGroupId;
             group.bRadio = bRadio;
 
-            m_groups.push_back(group);
+            playList.groups.push_back(group);
+            groupIds.insert(std::make_pair(group.strGroupName, group.iGroupId));
             iCurrentGroupId = iUniqueGroupId;
           }
           else
           {
-            iCurrentGroupId = pGroup->iGroupId;
+            iCurrentGroupId = itGroup->second;
           }
         }
       }
@@ -465,23 +844,23 @@ bool PVRIptvData::LoadPlayList(void)
     {
       PVRIptvChannel channel;
       channel.iUniqueId         = GetChannelId(tmpChannel.strChannelName.c_str(), strLine);
-      channel.iChannelNumber    = iChannelNum++;
+      channel.iChannelNumber    = 0;
       channel.strTvgId          = tmpChannel.strTvgId;
       channel.strChannelName    = tmpChannel.strChannelName;
       channel.strTvgName        = tmpChannel.strTvgName;
       channel.strTvgLogo        = tmpChannel.strTvgLogo;
       channel.iTvgShift         = tmpChannel.iTvgShift;
       channel.bRadio            = tmpChannel.bRadio;
-      channel.strStreamURL      = strLine;
+      channel.strStreamURL.assign(strLine, iLength);
       channel.iEncryptionSystem = 0;
 
       if (iCurrentGroupId > 0) 
       {
-        channel.bRadio = m_groups.at(iCurrentGroupId - 1).bRadio;
-        m_groups.at(iCurrentGroupId - 1).members.push_back(iChannelIndex);
+        channel.bRadio = playList.groups.at(iCurrentGroupId - 1).bRadio;
+        playList.groups.at(iCurrentGroupId - 1).members.push_back(iChannelIndex);
       }
 
-      m_channels.push_back(channel);
+      playList.channels.push_back(channel);
       iChannelIndex++;
 
       tmpChannel.strTvgId       = "";
@@ -492,18 +871,15 @@ bool PVRIptvData::LoadPlayList(void)
       tmpChannel.bRadio         = false;
     }
   }
-  
-  stream.clear();
 
-  if (m_channels.size() == 0)
+  reader.Close();
+
+  if (playList.channels.size() == 0)
   {
-    XBMC->Log(LOG_ERROR, "Unable to load channels from file '%s':  file is corrupted.", m_strM3uUrl.c_str());
+    XBMC->Log(LOG_ERROR, "Unable to load channels from file '%s':  file is corrupted.", strPath.c_str());
     return false;
   }
 
-  ApplyChannelsLogos();
-
-  XBMC->Log(LOG_NOTICE, "Loaded %d channels.", m_channels.size());
   return true;
 }
 
@@ -540,24 +916,21 @@ PVR_ERROR PVRIptvData::GetChannels(ADDON_HANDLE handle, bool bRadio)
 
 bool PVRIptvData::GetChannel(const PVR_CHANNEL &channel, PVRIptvChannel &myChannel)
 {
-  for (unsigned int iChannelPtr = 0; iChannelPtr < m_channels.size(); iChannelPtr++)
+  PVRIptvChannel *thisChannel;
+  if ((thisChannel = FindChannelByUid(channel.iUniqueId)) == NULL)
   {
-    PVRIptvChannel &thisChannel = m_channels.at(iChannelPtr);
-    if (thisChannel.iUniqueId == (int) channel.iUniqueId)
-    {
-      myChannel.iUniqueId         = thisChannel.iUniqueId;
-      myChannel.bRadio            = thisChannel.bRadio;
-      myChannel.iChannelNumber    = thisChannel.iChannelNumber;
-      myChannel.iEncryptionSystem = thisChannel.iEncryptionSystem;
-      myChannel.strChannelName    = thisChannel.strChannelName;
-      myChannel.strLogoPath       = thisChannel.strLogoPath;
-      myChannel.strStreamURL      = thisChannel.strStreamURL;
-
-      return true;
-    }
+    return false;
   }
 
-  return false;
+  myChannel.iUniqueId         = thisChannel->iUniqueId;
+  myChannel.bRadio            = thisChannel->bRadio;
+  myChannel.iChannelNumber    = thisChannel->iChannelNumber;
+  myChannel.iEncryptionSystem = thisChannel->iEncryptionSystem;
+  myChannel.strChannelName    = thisChannel->strChannelName;
+  myChannel.strLogoPath       = thisChannel->strLogoPath;
+  myChannel.strStreamURL      = thisChannel->strStreamURL;
+
+  return true;
 }
 
 int PVRIptvData::GetChannelGroupsAmount(void)
@@ -613,298 +986,379 @@ PVR_ERROR PVRIptvData::GetChannelGroupMembers(ADDON_HANDLE handle, const PVR_CHA
 
 PVR_ERROR PVRIptvData::GetEPGForChannel(ADDON_HANDLE handle, const PVR_CHANNEL &channel, time_t iStart, time_t iEnd)
 {
-  vector<PVRIptvChannel>::iterator myChannel;
-  for (myChannel = m_channels.begin(); myChannel < m_channels.end(); myChannel++)
+  PVRIptvChannel *myChannel;
+  if ((myChannel = FindChannelByUid(channel.iUniqueId)) == NULL)
   {
-    if (myChannel->iUniqueId != (int) channel.iUniqueId)
-    {
-      continue;
-    }
-
-    if (!m_bEGPLoaded || iStart > m_iLastStart || iEnd > m_iLastEnd) 
-    {
-      if (LoadEPG(iStart, iEnd))
-      {
-        m_iLastStart = iStart;
-        m_iLastEnd = iEnd;
-      }
-    }
+    return PVR_ERROR_NO_ERROR;
+  }
 
-    PVRIptvEpgChannel *epg;
-    if ((epg = FindEpgForChannel(*myChannel)) == NULL || epg->epg.size() == 0)
-    {
-      return PVR_ERROR_NO_ERROR;
-    }
+  // the whole guide is loaded once and then answers any window
+  if (!m_bEGPLoaded) 
+  {
+    LoadEPG();
+  }
 
-    int iShift = m_bTSOverride ? m_iEPGTimeShift : myChannel->iTvgShift + m_iEPGTimeShift;
+  CLockObject lock(m_epgMutex);
 
-    vector<PVRIptvEpgEntry>::iterator myTag;
-    for (myTag = epg->epg.begin(); myTag < epg->epg.end(); myTag++)
-    {
-      if ((myTag->endTime + iShift) < iStart) 
-        continue;
+  PVRIptvEpgChannel *epg;
+  if ((epg = FindEpgForChannel(*myChannel)) == NULL || epg->epg.size() == 0)
+  {
+    return PVR_ERROR_NO_ERROR;
+  }
 
-      EPG_TAG tag;
-      memset(&tag, 0, sizeof(EPG_TAG));
+  int iShift = m_bTSOverride ? m_iEPGTimeShift : myChannel->iTvgShift + m_iEPGTimeShift;
 
-      tag.iUniqueBroadcastId  = myTag->iBroadcastId;
-      tag.strTitle            = myTag->strTitle.c_str();
-      tag.iChannelNumber      = myTag->iChannelId;
-      tag.startTime           = myTag->startTime + iShift;
-      tag.endTime             = myTag->endTime + iShift;
-      tag.strPlotOutline      = myTag->strPlotOutline.c_str();
-      tag.strPlot             = myTag->strPlot.c_str();
-      tag.strIconPath         = myTag->strIconPath.c_str();
-      tag.iGenreType          = EPG_GENRE_USE_STRING;        //myTag.iGenreType;
-      tag.iGenreSubType       = 0;                           //myTag.iGenreSubType;
-      tag.strGenreDescription = myTag->strGenreString.c_str();
+  // entries are sorted by start time, begin with the one running at iStart
+  vector<PVRIptvEpgEntry>::iterator myTag = lower_bound(epg->epg.begin(), epg->epg.end(), iStart - iShift, EpgEntryStartsBeforeTime);
+  while (myTag != epg->epg.begin() && ((myTag - 1)->endTime + iShift) >= iStart)
+  {
+    myTag--;
+  }
 
-      PVR->TransferEpgEntry(handle, &tag);
+  for (; myTag < epg->epg.end(); myTag++)
+  {
+    if ((myTag->startTime + iShift) > iEnd)
+      break;
 
-      if ((myTag->startTime + iShift) > iEnd)
-        break;
-    }
+    if ((myTag->endTime + iShift) < iStart) 
+      continue;
 
-    return PVR_ERROR_NO_ERROR;
+    EPG_TAG tag;
+    memset(&tag, 0, sizeof(EPG_TAG));
+
+    tag.iUniqueBroadcastId  = myTag->iBroadcastId;
+    tag.strTitle            = myTag->strTitle;
+    tag.iChannelNumber      = myTag->iChannelId;
+    tag.startTime           = myTag->startTime + iShift;
+    tag.endTime             = myTag->endTime + iShift;
+    tag.strPlotOutline      = myTag->strPlotOutline;
+    tag.strPlot             = myTag->strPlot;
+    tag.strIconPath         = myTag->strIconPath;
+    tag.iGenreType          = EPG_GENRE_USE_STRING;        //myTag.iGenreType;
+    tag.iGenreSubType       = 0;                           //myTag.iGenreSubType;
+    tag.strGenreDescription = myTag->strGenreString;
+
+    PVR->TransferEpgEntry(handle, &tag);
   }
 
   return PVR_ERROR_NO_ERROR;
 }
 
-int PVRIptvData::GetFileContents(CStdString& url, std::string &strContent)
+time_t PVRIptvData::ParseXmltvDateTime(const char *strDate)
 {
-  strContent.clear();
-  void* fileHandle = XBMC->OpenFile(url.c_str(), 0);
-  if (fileHandle)
+  // YYYYMMDDhhmmss +hhmm, trailing time fields and the offset are optional
+  static const int iFieldDigits[6] = { 4, 2, 2, 2, 2, 2 };
+  int iFields[6] = { 0, 1, 1, 0, 0, 0 };
+
+  const char *pDate = strDate;
+  for (int iField = 0; iField < 6 && *pDate >= '0' && *pDate <= '9'; iField++)
   {
-    char buffer[1024];
-    while (int bytesRead = XBMC->ReadFile(fileHandle, buffer, 1024))
-      strContent.append(buffer, bytesRead);
-    XBMC->CloseFile(fileHandle);
+    int iValue = 0;
+    for (int iDigit = 0; iDigit < iFieldDigits[iField]; iDigit++, pDate++)
+    {
+      if (*pDate < '0' || *pDate > '9')
+        return 0;
+      iValue = iValue * 10 + (*pDate - '0');
+    }
+    iFields[iField] = iValue;
   }
 
-  return strContent.length();
-}
+  if (pDate == strDate || iFields[1] < 1 || iFields[1] > 12 || iFields[2] < 1 || iFields[2] > 31)
+    return 0;
 
-int PVRIptvData::ParseDateTime(CStdString strDate, bool iDateFormat)
-{
-  struct tm timeinfo;
-  memset(&timeinfo, 0, sizeof(tm));
+  while (*pDate == ' ')
+    pDate++;
 
-  if (iDateFormat)
+  if (*pDate != '+' && *pDate != '-')
   {
-    sscanf(strDate, "%04d%02d%02d%02d%02d%02d", &timeinfo.tm_year, &timeinfo.tm_mon, &timeinfo.tm_mday, &timeinfo.tm_hour, &timeinfo.tm_min, &timeinfo.tm_sec);
+    // no offset given, the time is local
+    struct tm timeinfo;
+    memset(&timeinfo, 0, sizeof(tm));
+    timeinfo.tm_year  = iFields[0] - 1900;
+    timeinfo.tm_mon   = iFields[1] - 1;
+    timeinfo.tm_mday  = iFields[2];
+    timeinfo.tm_hour  = iFields[3];
+    timeinfo.tm_min   = iFields[4];
+    timeinfo.tm_sec   = iFields[5];
+    timeinfo.tm_isdst = -1;
+
+    return mktime(&timeinfo);
   }
-  else
+
+  int iSign = *pDate++ == '-' ? -1 : 1;
+  int iOffset = 0;
+  for (int iDigit = 0; iDigit < 4; iDigit++, pDate++)
   {
-    sscanf(strDate, "%02d.%02d.%04d%02d:%02d:%02d", &timeinfo.tm_mday, &timeinfo.tm_mon, &timeinfo.tm_year, &timeinfo.tm_hour, &timeinfo.tm_min, &timeinfo.tm_sec);
+    if (*pDate < '0' || *pDate > '9')
+      return 0;
+    iOffset = iOffset * 10 + (*pDate - '0');
   }
+  iOffset = iSign * ((iOffset / 100) * 3600 + (iOffset % 100) * 60);
 
-  timeinfo.tm_mon  -= 1;
-  timeinfo.tm_year -= 1900;
-  timeinfo.tm_isdst = -1;
-
-  return mktime(&timeinfo);
+  time_t iTime = (time_t)DaysFromCivil(iFields[0], iFields[1], iFields[2]) * SECONDS_IN_DAY;
+  return iTime + iFields[3] * 3600 + iFields[4] * 60 + iFields[5] - iOffset;
 }
 
 PVRIptvChannel * PVRIptvData::FindChannel(const std::string &strId, const std::string &strName)
 {
+  PVRIptvChannel *pChannel = FirstMatch(m_channels, m_channelTvgIdIndex, strId, (PVRIptvChannel *)NULL);
+  if (strName.empty())
+  {
+    return pChannel;
+  }
+
   CStdString strTvgName = strName;
   strTvgName.Replace(' ', '_');
 
-  vector<PVRIptvChannel>::iterator it;
-  for(it = m_channels.begin(); it < m_channels.end(); it++)
+  pChannel = FirstMatch(m_channels, m_channelTvgNameIndex, strTvgName, pChannel);
+  pChannel = FirstMatch(m_channels, m_channelNameIndex, strName, pChannel);
+
+  return pChannel;
+}
+
+PVRIptvChannel * PVRIptvData::FindChannelByUid(int iUniqueId)
+{
+  std::map<int, int>::iterator it = m_channelUidIndex.find(iUniqueId);
+  if (it == m_channelUidIndex.end())
   {
-    if (it->strTvgId == strId)
-    {
-      return &*it;
-    }
-    if (strTvgName == "") 
-    {
-      continue;
-    }
-    if (it->strTvgName == strTvgName)
-    {
-      return &*it;
-    }
-    if (it->strChannelName == strName)
-    {
-      return &*it;
-    }
+    return NULL;
   }
 
-  return NULL;
+  return &m_channels.at(it->second);
 }
 
 PVRIptvChannelGroup * PVRIptvData::FindGroup(const std::string &strName)
 {
-  vector<PVRIptvChannelGroup>::iterator it;
-  for(it = m_groups.begin(); it < m_groups.end(); it++)
+  return FirstMatch(m_groups, m_groupNameIndex, strName, (PVRIptvChannelGroup *)NULL);
+}
+
+PVRIptvEpgChannel * PVRIptvData::FindEpg(const std::string &strId)
+{
+  return FirstMatch(m_epg.channels, m_epg.idIndex, strId, (PVRIptvEpgChannel *)NULL);
+}
+
+PVRIptvEpgChannel * PVRIptvData::FindEpgForChannel(PVRIptvChannel &channel)
+{
+  PVRIptvEpgChannel *pEpg = FirstMatch(m_epg.channels, m_epg.idIndex, channel.strTvgId, (PVRIptvEpgChannel *)NULL);
+  pEpg = FirstMatch(m_epg.channels, m_epg.tvgNameIndex, channel.strTvgName, pEpg);
+  pEpg = FirstMatch(m_epg.channels, m_epg.nameIndex, channel.strTvgName, pEpg);
+  pEpg = FirstMatch(m_epg.channels, m_epg.nameIndex, channel.strChannelName, pEpg);
+
+  return pEpg;
+}
+
+void PVRIptvData::IndexChannel(int iIndex)
+{
+  PVRIptvChannel &channel = m_channels.at(iIndex);
+
+  // insert() keeps the first channel for a key, as the former linear search did
+  m_channelUidIndex.insert(std::make_pair(channel.iUniqueId, iIndex));
+  m_channelTvgIdIndex.insert(std::make_pair(channel.strTvgId, iIndex));
+  m_channelTvgNameIndex.insert(std::make_pair(channel.strTvgName, iIndex));
+  m_channelNameIndex.insert(std::make_pair(channel.strChannelName, iIndex));
+}
+
+void PVRIptvData::IndexEpg(PVRIptvEpg &epg)
+{
+  epg.idIndex.clear();
+  epg.nameIndex.clear();
+  epg.tvgNameIndex.clear();
+
+  for (unsigned int iIndex = 0; iIndex < epg.channels.size(); iIndex++)
   {
-    if (it->strGroupName == strName)
-    {
-      return &*it;
-    }
-  }
+    PVRIptvEpgChannel &epgChannel = epg.channels.at(iIndex);
 
-  return NULL;
+    CStdString strTvgName = epgChannel.strName;
+    strTvgName.Replace(' ', '_');
+
+    epg.idIndex.insert(std::make_pair(epgChannel.strId, iIndex));
+    epg.nameIndex.insert(std::make_pair(epgChannel.strName, iIndex));
+    epg.tvgNameIndex.insert(std::make_pair(std::string(strTvgName), iIndex));
+  }
 }
 
-PVRIptvEpgChannel * PVRIptvData::FindEpg(const std::string &strId)
+void PVRIptvData::SortEpg(std::vector<PVRIptvEpgChannel> &epg)
 {
   vector<PVRIptvEpgChannel>::iterator it;
-  for(it = m_epg.begin(); it < m_epg.end(); it++)
+  for (it = epg.begin(); it < epg.end(); it++)
   {
-    if (it->strId == strId)
-    {
-      return &*it;
-    }
+    std::stable_sort(it->epg.begin(), it->epg.end(), EpgEntryStartsBefore);
   }
+}
 
-  return NULL;
+bool PVRIptvData::IsCacheUpToDate(const std::string &strCachedPath, const std::string &strFilePath)
+{
+  // check cached file is exists
+  if (!XBMC->FileExists(strCachedPath.c_str(), false))
+    return false;
+
+  struct __stat64 statCached;
+  struct __stat64 statOrig;
+  memset(&statCached, 0, sizeof(statCached));
+  memset(&statOrig, 0, sizeof(statOrig));
+
+  XBMC->StatFile(strCachedPath.c_str(), &statCached);
+  XBMC->StatFile(strFilePath.c_str(), &statOrig);
+
+  return !(statCached.st_mtime < statOrig.st_mtime || statOrig.st_mtime == 0);
 }
 
-PVRIptvEpgChannel * PVRIptvData::FindEpgForChannel(PVRIptvChannel &channel)
+bool PVRIptvData::LoadEPGSnapshot(PVRIptvEpg &epg)
 {
-  vector<PVRIptvEpgChannel>::iterator it;
-  for(it = m_epg.begin(); it < m_epg.end(); it++)
+  std::string strSnapshotPath = GetUserFilePath(EPG_FILE_NAME);
+  if (!XBMC->FileExists(strSnapshotPath.c_str(), false))
+    return false;
+
+  std::vector<int64_t> sourceStats;
+  if (!StatSources(SplitSources(m_strXMLTVUrl), sourceStats))
+    return false;
+
+  EpgSnapshotFile file;
+  if (!file.OpenForRead(strSnapshotPath))
+    return false;
+
+  // the snapshot is only valid for the same source files and playlist
+  uint32_t iMagic, iVersion, iSourceStats, iSourceHash, iChannelsHash, iChannels;
+  bool     bValid = file.ReadValue(iMagic) && iMagic == EPG_SNAPSHOT_MAGIC
+    && file.ReadValue(iVersion) && iVersion == EPG_SNAPSHOT_VERSION
+    && file.ReadValue(iSourceStats) && iSourceStats == sourceStats.size();
+
+  for (uint32_t iStat = 0; bValid && iStat < iSourceStats; iStat++)
   {
-    if (it->strId == channel.strTvgId)
-    {
-      return &*it;
-    }
-    CStdString strName = it->strName;
-    strName.Replace(' ', '_');
-    if (strName == channel.strTvgName
-      || it->strName == channel.strTvgName)
-    {
-      return &*it;
-    }
-    if (it->strName == channel.strChannelName)
-    {
-      return &*it;
-    }
+    int64_t iValue;
+    bValid = file.ReadValue(iValue) && iValue == sourceStats[iStat];
   }
 
-  return NULL;
-}
+  if (!bValid
+    || !file.ReadValue(iSourceHash) || iSourceHash != HashString(0, m_strXMLTVUrl)
+    || !file.ReadValue(iChannelsHash) || iChannelsHash != GetChannelsHash()
+    || !file.ReadValue(iChannels))
+  {
+    XBMC->Log(LOG_DEBUG, "EPG snapshot is out of date.");
+    return false;
+  }
 
-/*
- * This method uses zlib to decompress a gzipped file in memory.
- * Author: Andrew Lim Chong Liang
- * http://windrealm.org
- */
-bool PVRIptvData::GzipInflate( const std::string& compressedBytes, std::string& uncompressedBytes ) {  
+  epg.channels.clear();
+  epg.strings.Clear();
+  bool bOk = true;
+  for (uint32_t iChannel = 0; bOk && iChannel < iChannels; iChannel++)
+  {
+    epg.channels.push_back(PVRIptvEpgChannel());
+    PVRIptvEpgChannel &epgChannel = epg.channels.back();
 
-#define HANDLE_CALL_ZLIB(status) {   \
-  if(status != Z_OK) {        \
-    free(uncomp);             \
-    return false;             \
-  }                           \
-}
+    uint32_t iEntries = 0;
+    bOk = file.ReadString(epgChannel.strId) && file.ReadString(epgChannel.strName) && file.ReadValue(iEntries);
 
-  if ( compressedBytes.size() == 0 ) 
-  {  
-    uncompressedBytes = compressedBytes ;  
-    return true ;  
-  }  
-  
-  uncompressedBytes.clear() ;  
-  
-  unsigned full_length = compressedBytes.size() ;  
-  unsigned half_length = compressedBytes.size() / 2;  
-  
-  unsigned uncompLength = full_length ;  
-  char* uncomp = (char*) calloc( sizeof(char), uncompLength );  
-  
-  z_stream strm;  
-  strm.next_in = (Bytef *) compressedBytes.c_str();  
-  strm.avail_in = compressedBytes.size() ;  
-  strm.total_out = 0;  
-  strm.zalloc = Z_NULL;  
-  strm.zfree = Z_NULL;  
-  
-  bool done = false ;  
-  
-  HANDLE_CALL_ZLIB(inflateInit2(&strm, (16+MAX_WBITS)));
-  
-  while (!done) 
-  {  
-    // If our output buffer is too small  
-    if (strm.total_out >= uncompLength ) 
+    for (uint32_t iEntry = 0; bOk && iEntry < iEntries; iEntry++)
     {
-      // Increase size of output buffer  
-      uncomp = (char *) realloc(uncomp, uncompLength + half_length);
-      if (uncomp == NULL)
-        return false;
-      uncompLength += half_length ;  
-    }  
-  
-    strm.next_out = (Bytef *) (uncomp + strm.total_out);  
-    strm.avail_out = uncompLength - strm.total_out;  
-  
-    // Inflate another chunk.  
-    int err = inflate (&strm, Z_SYNC_FLUSH);  
-    if (err == Z_STREAM_END) 
-      done = true;  
-    else if (err != Z_OK)  
-    {  
-      break;  
-    }  
-  }  
-  
-  HANDLE_CALL_ZLIB(inflateEnd (&strm));
-  
-  for ( size_t i=0; i<strm.total_out; ++i ) 
-  {  
-    uncompressedBytes += uncomp[ i ];  
-  }  
+      int32_t iBroadcastId, iChannelId, iGenreType, iGenreSubType;
+      int64_t iEntryStart, iEntryEnd;
+
+      epgChannel.epg.push_back(PVRIptvEpgEntry());
+      PVRIptvEpgEntry &entry = epgChannel.epg.back();
+
+      bOk = file.ReadValue(iBroadcastId) && file.ReadValue(iChannelId)
+        && file.ReadValue(iGenreType) && file.ReadValue(iGenreSubType)
+        && file.ReadValue(iEntryStart) && file.ReadValue(iEntryEnd)
+        && file.ReadPooledString(epg.strings, entry.strTitle) && file.ReadPooledString(epg.strings, entry.strPlotOutline)
+        && file.ReadPooledString(epg.strings, entry.strPlot) && file.ReadPooledString(epg.strings, entry.strIconPath)
+        && file.ReadPooledString(epg.strings, entry.strGenreString);
+
+      entry.iBroadcastId  = iBroadcastId;
+      entry.iChannelId    = iChannelId;
+      entry.iGenreType    = iGenreType;
+      entry.iGenreSubType = iGenreSubType;
+      entry.startTime     = (time_t)iEntryStart;
+      entry.endTime       = (time_t)iEntryEnd;
+    }
+  }
 
-  free( uncomp );  
-  return true ;  
-}  
+  if (!bOk || !file.ReadChecksum())
+  {
+    XBMC->Log(LOG_ERROR, "EPG snapshot '%s' is corrupted.", strSnapshotPath.c_str());
+    epg.channels.clear();
+    epg.strings.Clear();
+    return false;
+  }
 
-int PVRIptvData::GetCachedFileContents(const std::string &strCachedName, const std::string &filePath, 
-                                       std::string &strContents, const bool bUseCache /* false */)
+  return true;
+}
+
+void PVRIptvData::SaveEPGSnapshot(const std::vector<PVRIptvEpgChannel> &epg)
 {
-  bool bNeedReload = false;
-  CStdString strCachedPath = GetUserFilePath(strCachedName);
-  CStdString strFilePath = filePath;
+  std::string strSnapshotPath = GetUserFilePath(EPG_FILE_NAME);
 
-  // check cached file is exists
-  if (bUseCache && XBMC->FileExists(strCachedPath, false)) 
+  std::vector<int64_t> sourceStats;
+  if (!StatSources(SplitSources(m_strXMLTVUrl), sourceStats))
   {
-    struct __stat64 statCached;
-    struct __stat64 statOrig;
+    // can't tell later if the source has changed
+    if (XBMC->FileExists(strSnapshotPath.c_str(), false))
+      XBMC->DeleteFile(strSnapshotPath.c_str());
+    return;
+  }
 
-    XBMC->StatFile(strCachedPath, &statCached);
-    XBMC->StatFile(strFilePath, &statOrig);
+  EpgSnapshotFile file;
+  if (!file.OpenForWrite(strSnapshotPath))
+  {
+    XBMC->Log(LOG_ERROR, "Unable to write EPG snapshot '%s'.", strSnapshotPath.c_str());
+    return;
+  }
 
-    bNeedReload = statCached.st_mtime < statOrig.st_mtime || statOrig.st_mtime == 0;
-  } 
-  else 
+  file.WriteValue((uint32_t)EPG_SNAPSHOT_MAGIC);
+  file.WriteValue((uint32_t)EPG_SNAPSHOT_VERSION);
+  file.WriteValue((uint32_t)sourceStats.size());
+  for (unsigned int iStat = 0; iStat < sourceStats.size(); iStat++)
   {
-    bNeedReload = true;
+    file.WriteValue(sourceStats[iStat]);
   }
+  file.WriteValue(HashString(0, m_strXMLTVUrl));
+  file.WriteValue((uint32_t)GetChannelsHash());
+  file.WriteValue((uint32_t)epg.size());
 
-  if (bNeedReload) 
+  vector<PVRIptvEpgChannel>::const_iterator it;
+  for (it = epg.begin(); it < epg.end(); it++)
   {
-    GetFileContents(strFilePath, strContents);
+    file.WriteString(it->strId);
+    file.WriteString(it->strName);
+    file.WriteValue((uint32_t)it->epg.size());
 
-    // write to cache
-    if (bUseCache && strContents.length() > 0) 
+    vector<PVRIptvEpgEntry>::const_iterator entry;
+    for (entry = it->epg.begin(); entry < it->epg.end(); entry++)
     {
-      void* fileHandle = XBMC->OpenFileForWrite(strCachedPath, true);
-      if (fileHandle)
-      {
-        XBMC->WriteFile(fileHandle, strContents.c_str(), strContents.length());
-        XBMC->CloseFile(fileHandle);
-      }
+      file.WriteValue((int32_t)entry->iBroadcastId);
+      file.WriteValue((int32_t)entry->iChannelId);
+      file.WriteValue((int32_t)entry->iGenreType);
+      file.WriteValue((int32_t)entry->iGenreSubType);
+      file.WriteValue((int64_t)entry->startTime);
+      file.WriteValue((int64_t)entry->endTime);
+      file.WritePooledString(entry->strTitle);
+      file.WritePooledString(entry->strPlotOutline);
+      file.WritePooledString(entry->strPlot);
+      file.WritePooledString(entry->strIconPath);
+      file.WritePooledString(entry->strGenreString);
     }
-    return strContents.length();
-  } 
+  }
 
-  return GetFileContents(strCachedPath, strContents);
+  if (!file.Close())
+  {
+    XBMC->Log(LOG_ERROR, "Unable to write EPG snapshot '%s'.", strSnapshotPath.c_str());
+    XBMC->DeleteFile(strSnapshotPath.c_str());
+  }
+}
+
+unsigned int PVRIptvData::GetChannelsHash(void)
+{
+  uint32_t iHash = 0;
+
+  vector<PVRIptvChannel>::iterator it;
+  for (it = m_channels.begin(); it < m_channels.end(); it++)
+  {
+    iHash = HashString(iHash, it->strTvgId);
+    iHash = HashString(iHash, it->strTvgName);
+    iHash = HashString(iHash, it->strChannelName);
+  }
+
+  return iHash;
 }
 
 void PVRIptvData::ApplyChannelsLogos()
@@ -934,13 +1388,15 @@ void PVRIptvData::ReaplyChannelsLogos(const char * strNewPath)
 
 void PVRIptvData::ReloadEPG(const char * strNewPath)
 {
+  // the refresh thread reads the source path and the load state
+  CLockObject lock(m_loadMutex);
   if (strNewPath != m_strXMLTVUrl)
   {
     m_strXMLTVUrl = strNewPath;
     m_bEGPLoaded = false;
     // TODO clear epg for all channels
 
-    if (LoadEPG(m_iLastStart, m_iLastEnd))
+    if (LoadEPG())
     {
       for(unsigned int iChannelPtr = 0, max = m_channels.size(); iChannelPtr < max; iChannelPtr++)
       {
@@ -953,10 +1409,18 @@ void PVRIptvData::ReloadEPG(const char * strNewPath)
 
 void PVRIptvData::ReloadPlayList(const char * strNewPath)
 {
+  // the refresh thread looks channels up while it reloads the guide
+  CLockObject lock(m_loadMutex);
   if (strNewPath != m_strM3uUrl)
   {
     m_strM3uUrl = strNewPath;
     m_channels.clear();
+    m_groups.clear();
+    m_groupNameIndex.clear();
+    m_channelUidIndex.clear();
+    m_channelTvgIdIndex.clear();
+    m_channelTvgNameIndex.clear();
+    m_channelNameIndex.clear();
 
     if (LoadPlayList())
     {
@@ -966,33 +1430,6 @@ void PVRIptvData::ReloadPlayList(const char * strNewPath)
   }
 }
 
-CStdString PVRIptvData::ReadMarkerValue(std::string &strLine, const char* strMarkerName)
-{
-  int iMarkerStart = (int) strLine.find(strMarkerName);
-  if (iMarkerStart >= 0)
-  {
-    std::string strMarker = strMarkerName;
-    iMarkerStart += strMarker.length();
-    if (iMarkerStart < (int)strLine.length())
-    {
-      char cFind = ' ';
-      if (strLine[iMarkerStart] == '"')
-      {
-        cFind = '"';
-        iMarkerStart++;
-      }
-      int iMarkerEnd = (int)strLine.find(cFind, iMarkerStart);
-      if (iMarkerEnd < 0)
-      {
-        iMarkerEnd = strLine.length();
-      }
-      return strLine.substr(iMarkerStart, iMarkerEnd - iMarkerStart);
-    }
-  }
-
-  return std::string("");
-}
-
 int PVRIptvData::GetChannelId(const char * strChannelName, const char * strStreamUrl) 
 {
   std::string concat(strChannelName);
@@ -25,9 +25,11 @@
  */
 
 #include <vector>
+#include <map>
 #include "platform/util/StdString.h"
 #include "client.h"
 #include "platform/threads/threads.h"
+#include "StringPool.h"
 
 struct PVRIptvEpgEntry
 {
@@ -37,11 +39,11 @@ struct PVRIptvEpgEntry
   int         iGenreSubType;
   time_t      startTime;
   time_t      endTime;
-  std::string strTitle;
-  std::string strPlotOutline;
-  std::string strPlot;
-  std::string strIconPath;
-  std::string strGenreString;
+  const char *strTitle;       // the text fields are owned by the StringPool of the guide
+  const char *strPlotOutline;
+  const char *strPlot;
+  const char *strIconPath;
+  const char *strGenreString;
 };
 
 struct PVRIptvEpgChannel
@@ -74,8 +76,64 @@ struct PVRIptvChannelGroup
   std::vector<int>  members;
 };
 
+struct PVRIptvPlayList
+{
+  std::vector<PVRIptvChannel>      channels;
+  std::vector<PVRIptvChannelGroup> groups;
+};
+
+struct PVRIptvGuide
+{
+  bool                             bReadError;
+  std::vector<PVRIptvEpgChannel>   epg;
+  StringPool                       strings;
+};
+
+/*!
+ * @brief The loaded guide with its lookup indexes, each key maps to the first channel having it.
+ */
+struct PVRIptvEpg
+{
+  std::vector<PVRIptvEpgChannel>   channels;
+  std::map<std::string, int>       idIndex;
+  std::map<std::string, int>       nameIndex;
+  std::map<std::string, int>       tvgNameIndex;
+  StringPool                       strings;
+};
+
+class PVRIptvData;
+
+/*!
+ * @brief Loads one playlist or guide source, on its own thread when there are several.
+ */
+class PVRIptvSourceLoader : public PLATFORM::CThread
+{
+public:
+  PVRIptvSourceLoader(PVRIptvData *data, int iSource, const std::string &strPath, bool bPlayList);
+
+  virtual void *Process(void);
+
+  /*!
+   * @brief Wait until Process() has finished.
+   */
+  void WaitFinished(void) { m_finished.Wait(); }
+
+  bool            m_bLoaded;
+  PVRIptvPlayList m_playList;
+  PVRIptvGuide    m_guide;
+
+private:
+  PVRIptvData    *m_data;
+  int             m_iSource;
+  std::string     m_strPath;
+  bool            m_bPlayList;
+  PLATFORM::CEvent m_finished;
+};
+
 class PVRIptvData : public PLATFORM::CThread
 {
+  friend class PVRIptvSourceLoader;
+
 public:
   PVRIptvData(void);
   virtual ~PVRIptvData(void);
@@ -93,18 +151,25 @@ public:
 
 protected:
   virtual bool                 LoadPlayList(void);
-  virtual bool                 LoadEPG(time_t iStart, time_t iEnd);
-  virtual int                  GetFileContents(CStdString& url, std::string &strContent);
+  virtual bool                 LoadEPG(void);
+  virtual bool                 LoadPlayListSource(int iSource, const std::string &strPath, PVRIptvPlayList &playList);
+  virtual bool                 LoadEPGSource(int iSource, const std::string &strPath, PVRIptvGuide &guide);
+  virtual bool                 IsEPGOutdated(void);
+  virtual void                 RunLoaders(std::vector<PVRIptvSourceLoader *> &loaders);
   virtual PVRIptvChannel      *FindChannel(const std::string &strId, const std::string &strName);
   virtual PVRIptvChannelGroup *FindGroup(const std::string &strName);
   virtual PVRIptvEpgChannel   *FindEpg(const std::string &strId);
   virtual PVRIptvEpgChannel   *FindEpgForChannel(PVRIptvChannel &channel);
-  virtual int                  ParseDateTime(CStdString strDate, bool iDateFormat = true);
-  virtual bool                 GzipInflate( const std::string &compressedBytes, std::string &uncompressedBytes);
-  virtual int                  GetCachedFileContents(const std::string &strCachedName, const std::string &strFilePath, 
-                                                     std::string &strContent, const bool bUseCache = false);
+  virtual PVRIptvChannel      *FindChannelByUid(int iUniqueId);
+  virtual void                 IndexChannel(int iIndex);
+  virtual void                 IndexEpg(PVRIptvEpg &epg);
+  virtual void                 SortEpg(std::vector<PVRIptvEpgChannel> &epg);
+  virtual time_t               ParseXmltvDateTime(const char *strDate);
+  virtual bool                 IsCacheUpToDate(const std::string &strCachedPath, const std::string &strFilePath);
+  virtual bool                 LoadEPGSnapshot(PVRIptvEpg &epg);
+  virtual void                 SaveEPGSnapshot(const std::vector<PVRIptvEpgChannel> &epg);
+  virtual unsigned int         GetChannelsHash(void);
   virtual void                 ApplyChannelsLogos();
-  virtual CStdString           ReadMarkerValue(std::string &strLine, const char * strMarkerName);
   virtual int                  GetChannelId(const char * strChannelName, const char * strStreamUrl);
 
 protected:
@@ -114,12 +179,21 @@ private:
   bool                              m_bTSOverride;
   bool                              m_bEGPLoaded;
   int                               m_iEPGTimeShift;
-  int                               m_iLastStart;
-  int                               m_iLastEnd;
+  time_t                            m_iEPGLoadTime;
+  std::vector<int64_t>              m_epgSourceStats;
   CStdString                        m_strXMLTVUrl;
   CStdString                        m_strM3uUrl;
   CStdString                        m_strLogoPath;
   std::vector<PVRIptvChannelGroup>  m_groups;
   std::vector<PVRIptvChannel>       m_channels;
-  std::vector<PVRIptvEpgChannel>    m_epg;
+  PVRIptvEpg                        m_epg;
+  PLATFORM::CMutex                  m_epgMutex;   // guards m_epg, a refresh swaps it in one go
+  PLATFORM::CMutex                  m_loadMutex;  // serializes guide loads and source reloads
+
+  // lookup indexes, each key maps to the first vector position having it
+  std::map<int, int>                m_channelUidIndex;
+  std::map<std::string, int>        m_channelTvgIdIndex;
+  std::map<std::string, int>        m_channelTvgNameIndex;
+  std::map<std::string, int>        m_channelNameIndex;
+  std::map<std::string, int>        m_groupNameIndex;
 };
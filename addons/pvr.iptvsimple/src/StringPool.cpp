@@ -0,0 +1,158 @@
+/*
+ *      Copyright (C) 2013 Anton Fedchin
+ *      http://github.com/afedchin/xbmc-addon-iptvsimple/
+ *
+ *      Copyright (C) 2011 Pulse-Eight
+ *      http://www.pulse-eight.com/
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1301  USA
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <string.h>
+#include <algorithm>
+#include "StringPool.h"
+
+#define STRING_POOL_BLOCK_SIZE  65536
+#define STRING_POOL_TABLE_SIZE  4096 // initial hash table size, a power of 2
+
+static inline size_t HashText(const char *strText, size_t iLength)
+{
+  // FNV-1a
+  size_t iHash = 2166136261U;
+  for (size_t i = 0; i < iLength; i++)
+  {
+    iHash ^= (unsigned char)strText[i];
+    iHash *= 16777619U;
+  }
+  return iHash;
+}
+
+StringPool::StringPool(void)
+{
+  m_pFree  = NULL;
+  m_iFree  = 0;
+  m_iCount = 0;
+}
+
+StringPool::~StringPool(void)
+{
+  Clear();
+}
+
+const char *StringPool::Intern(const char *strText, size_t iLength)
+{
+  if (iLength == 0)
+    return "";
+
+  if (m_table.empty())
+    m_table.resize(STRING_POOL_TABLE_SIZE, NULL);
+
+  // open addressing with linear probing
+  size_t iMask = m_table.size() - 1;
+  size_t iSlot = HashText(strText, iLength) & iMask;
+  while (m_table[iSlot] != NULL)
+  {
+    const char *strStored = m_table[iSlot];
+    if (strncmp(strStored, strText, iLength) == 0 && strStored[iLength] == '\0')
+      return strStored;
+    iSlot = (iSlot + 1) & iMask;
+  }
+
+  char *strCopy = Allocate(iLength + 1);
+  memcpy(strCopy, strText, iLength);
+  strCopy[iLength] = '\0';
+  m_table[iSlot] = strCopy;
+
+  // keep the table at most half full
+  if (++m_iCount * 2 > m_table.size())
+    Grow();
+
+  return strCopy;
+}
+
+void StringPool::Adopt(StringPool &other)
+{
+  m_blocks.insert(m_blocks.end(), other.m_blocks.begin(), other.m_blocks.end());
+  other.m_blocks.clear();
+  other.Clear();
+}
+
+void StringPool::Swap(StringPool &other)
+{
+  m_blocks.swap(other.m_blocks);
+  m_table.swap(other.m_table);
+  std::swap(m_pFree, other.m_pFree);
+  std::swap(m_iFree, other.m_iFree);
+  std::swap(m_iCount, other.m_iCount);
+}
+
+void StringPool::Clear(void)
+{
+  for (unsigned int iBlock = 0; iBlock < m_blocks.size(); iBlock++)
+  {
+    delete[] m_blocks[iBlock];
+  }
+  m_blocks.clear();
+  m_table.clear();
+  m_pFree  = NULL;
+  m_iFree  = 0;
+  m_iCount = 0;
+}
+
+char *StringPool::Allocate(size_t iLength)
+{
+  // long strings get a block of their own, the current one stays in use
+  if (iLength > STRING_POOL_BLOCK_SIZE / 4)
+  {
+    char *pData = new char[iLength];
+    m_blocks.push_back(pData);
+    return pData;
+  }
+
+  if (iLength > m_iFree)
+  {
+    m_pFree = new char[STRING_POOL_BLOCK_SIZE];
+    m_iFree = STRING_POOL_BLOCK_SIZE;
+    m_blocks.push_back(m_pFree);
+  }
+
+  char *pData = m_pFree;
+  m_pFree += iLength;
+  m_iFree -= iLength;
+  return pData;
+}
+
+void StringPool::Grow(void)
+{
+  std::vector<const char *> table(m_table.size() * 2, NULL);
+  size_t iMask = table.size() - 1;
+
+  for (unsigned int iEntry = 0; iEntry < m_table.size(); iEntry++)
+  {
+    const char *strStored = m_table[iEntry];
+    if (strStored == NULL)
+      continue;
+
+    size_t iSlot = HashText(strStored, strlen(strStored)) & iMask;
+    while (table[iSlot] != NULL)
+      iSlot = (iSlot + 1) & iMask;
+    table[iSlot] = strStored;
+  }
+
+  m_table.swap(table);
+}
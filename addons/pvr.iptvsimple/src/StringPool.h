@@ -0,0 +1,69 @@
+#pragma once
+/*
+ *      Copyright (C) 2013 Anton Fedchin
+ *      http://github.com/afedchin/xbmc-addon-iptvsimple/
+ *
+ *      Copyright (C) 2011 Pulse-Eight
+ *      http://www.pulse-eight.com/
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1301  USA
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+#include <string>
+#include <vector>
+
+/*!
+ * @brief Storage for the text of EPG entries.
+ * Each distinct string is stored once, in large blocks, and returned as a
+ * pointer which stays valid until the pool is cleared or destroyed, so it
+ * can be handed to EPG_TAG as it is.
+ */
+class StringPool
+{
+public:
+  StringPool(void);
+  virtual ~StringPool(void);
+
+  /*!
+   * @brief Get the stored copy of a string, adding it if it isn't in the pool yet.
+   * @return A zero terminated string owned by the pool, "" for an empty string.
+   */
+  const char *Intern(const char *strText, size_t iLength);
+  const char *Intern(const std::string &strText) { return Intern(strText.c_str(), strText.length()); }
+
+  /*!
+   * @brief Take over the strings of another pool, which is left empty.
+   * Their pointers stay valid, but they are not reused by later Intern() calls.
+   */
+  void Adopt(StringPool &other);
+
+  void Swap(StringPool &other);
+  void Clear(void);
+
+private:
+  StringPool(const StringPool &);
+  StringPool &operator=(const StringPool &);
+
+  char *Allocate(size_t iLength);
+  void  Grow(void);
+
+  std::vector<char *>       m_blocks;
+  char                     *m_pFree;
+  size_t                    m_iFree;
+  std::vector<const char *> m_table;
+  size_t                    m_iCount;
+};
@@ -0,0 +1,310 @@
+/*
+ *      Copyright (C) 2013 Anton Fedchin
+ *      http://github.com/afedchin/xbmc-addon-iptvsimple/
+ *
+ *      Copyright (C) 2011 Pulse-Eight
+ *      http://www.pulse-eight.com/
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1301  USA
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <string.h>
+#include "XmltvReader.h"
+#include "client.h"
+
+#define XMLTV_READ_CHUNK_SIZE   65536
+#define XMLTV_INFLATE_SIZE      262144
+#define XMLTV_CHANNEL_TAG       "channel"
+#define XMLTV_PROGRAMME_TAG     "programme"
+#define XMLTV_MAX_TAG_LENGTH    11 // "<programme" and a delimiter
+
+using namespace ADDON;
+using namespace rapidxml;
+
+static inline bool IsElementName(const char *strText, size_t iLength, const char *strName, size_t iNameLen)
+{
+  if (iLength <= iNameLen || strncmp(strText, strName, iNameLen) != 0)
+    return false;
+
+  char c = strText[iNameLen];
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '>' || c == '/';
+}
+
+XmltvReader::XmltvReader(void)
+{
+  m_fileHandle = NULL;
+  m_copyHandle = NULL;
+  m_bGzip      = false;
+  m_bEof       = true;
+  m_bError     = false;
+  m_bMemberEnd = false;
+  m_iPos       = 0;
+  memset(&m_zStream, 0, sizeof(z_stream));
+}
+
+XmltvReader::~XmltvReader(void)
+{
+  Close();
+}
+
+bool XmltvReader::Open(const std::string &strPath, const std::string &strCopyPath)
+{
+  Close();
+
+  m_fileHandle = XBMC->OpenFile(strPath.c_str(), 0);
+  if (!m_fileHandle)
+    return false;
+
+  m_readBuffer.resize(XMLTV_READ_CHUNK_SIZE);
+  unsigned int iRead = XBMC->ReadFile(m_fileHandle, &m_readBuffer[0], m_readBuffer.size());
+  if (iRead == 0)
+  {
+    Close();
+    return false;
+  }
+
+  if (!strCopyPath.empty())
+    m_copyHandle = XBMC->OpenFileForWrite(strCopyPath.c_str(), true);
+
+  // gzip packed
+  if (iRead >= 3 && m_readBuffer[0] == '\x1F' && m_readBuffer[1] == '\x8B' && m_readBuffer[2] == '\x08')
+  {
+    if (inflateInit2(&m_zStream, 16 + MAX_WBITS) != Z_OK)
+    {
+      Close();
+      return false;
+    }
+    m_bGzip = true;
+    m_inflateBuffer.resize(XMLTV_INFLATE_SIZE);
+  }
+
+  m_bEof = false;
+  // what was inflated before an error is still read
+  return Decode(iRead) || !m_buffer.empty();
+}
+
+void XmltvReader::Close(void)
+{
+  if (m_fileHandle)
+  {
+    XBMC->CloseFile(m_fileHandle);
+    m_fileHandle = NULL;
+  }
+  if (m_copyHandle)
+  {
+    XBMC->CloseFile(m_copyHandle);
+    m_copyHandle = NULL;
+  }
+  if (m_bGzip)
+  {
+    inflateEnd(&m_zStream);
+    memset(&m_zStream, 0, sizeof(z_stream));
+    m_bGzip = false;
+  }
+
+  m_bEof = true;
+  m_bMemberEnd = false;
+  m_iPos = 0;
+  m_buffer.clear();
+  m_element.clear();
+  m_document.clear();
+}
+
+xml_node<> *XmltvReader::NextElement(void)
+{
+  while (true)
+  {
+    size_t iNameLen = 0;
+    size_t iStart = FindElementStart(m_iPos, iNameLen);
+    if (iStart != std::string::npos)
+    {
+      size_t iEnd = FindElementEnd(iStart, iNameLen);
+      if (iEnd != std::string::npos)
+      {
+        m_iPos = iEnd;
+        m_element.assign(m_buffer.begin() + iStart, m_buffer.begin() + iEnd);
+        m_element.push_back('\0');
+
+        m_document.clear();
+        try
+        {
+          m_document.parse<0>(&m_element[0]);
+        }
+        catch(parse_error p)
+        {
+          XBMC->Log(LOG_DEBUG, "Skipping invalid EPG XML element: %s", p.what());
+          continue;
+        }
+
+        xml_node<> *pNode = m_document.first_node();
+        if (pNode)
+          return pNode;
+        continue;
+      }
+
+      // element is not complete yet: keep it
+      m_buffer.erase(0, iStart);
+    }
+    else
+    {
+      // keep the end of buffer which may hold a truncated start tag
+      size_t iKeep = m_buffer.size() > XMLTV_MAX_TAG_LENGTH ? m_buffer.size() - XMLTV_MAX_TAG_LENGTH : 0;
+      m_buffer.erase(0, m_iPos > iKeep ? m_iPos : iKeep);
+    }
+    m_iPos = 0;
+
+    // data read before an error or the end of input is still scanned
+    size_t iSize = m_buffer.size();
+    if (!Fill() && m_buffer.size() == iSize)
+      return NULL;
+  }
+}
+
+bool XmltvReader::Fill(void)
+{
+  if (m_bEof || m_bError)
+    return false;
+
+  unsigned int iRead = XBMC->ReadFile(m_fileHandle, &m_readBuffer[0], m_readBuffer.size());
+  if (iRead == 0)
+  {
+    m_bEof = true;
+    return false;
+  }
+
+  return Decode(iRead);
+}
+
+bool XmltvReader::Decode(unsigned int iRead)
+{
+  if (m_copyHandle)
+    XBMC->WriteFile(m_copyHandle, &m_readBuffer[0], iRead);
+
+  if (!m_bGzip)
+  {
+    m_buffer.append(&m_readBuffer[0], iRead);
+    return true;
+  }
+
+  m_zStream.next_in  = (Bytef *) &m_readBuffer[0];
+  m_zStream.avail_in = iRead;
+  if (m_bMemberEnd)
+  {
+    m_bMemberEnd = false;
+    if (!IsMemberStart())
+    {
+      // trailing data after the last gzip member is ignored
+      m_bEof = true;
+      return true;
+    }
+    inflateReset(&m_zStream);
+  }
+
+  do
+  {
+    m_zStream.next_out  = (Bytef *) &m_inflateBuffer[0];
+    m_zStream.avail_out = m_inflateBuffer.size();
+
+    int iStatus = inflate(&m_zStream, Z_NO_FLUSH);
+    m_buffer.append(&m_inflateBuffer[0], m_inflateBuffer.size() - m_zStream.avail_out);
+
+    if (iStatus == Z_STREAM_END)
+    {
+      // another gzip member may follow, possibly in the next chunk
+      if (m_zStream.avail_in == 0)
+      {
+        m_bMemberEnd = true;
+        break;
+      }
+      if (!IsMemberStart())
+      {
+        // trailing data after the last gzip member is ignored
+        m_bEof = true;
+        break;
+      }
+      inflateReset(&m_zStream);
+    }
+    else if (iStatus == Z_BUF_ERROR)
+    {
+      break;
+    }
+    else if (iStatus != Z_OK)
+    {
+      XBMC->Log(LOG_ERROR, "Unable to decompress EPG data (zlib error %d).", iStatus);
+      m_bError = true;
+      return false;
+    }
+  }
+  while (m_zStream.avail_in > 0 || m_zStream.avail_out == 0);
+
+  return true;
+}
+
+bool XmltvReader::IsMemberStart(void) const
+{
+  // gzip magic, its second byte may be in the next chunk
+  const Bytef *pIn = m_zStream.next_in;
+  return pIn[0] == 0x1F && (m_zStream.avail_in < 2 || pIn[1] == 0x8B);
+}
+
+size_t XmltvReader::FindElementStart(size_t iPos, size_t &iNameLen) const
+{
+  static const size_t iChannelLen = strlen(XMLTV_CHANNEL_TAG);
+  static const size_t iProgrammeLen = strlen(XMLTV_PROGRAMME_TAG);
+
+  while ((iPos = m_buffer.find('<', iPos)) != std::string::npos)
+  {
+    const char *strName = m_buffer.c_str() + iPos + 1;
+    size_t iLength = m_buffer.size() - iPos - 1;
+
+    if (IsElementName(strName, iLength, XMLTV_PROGRAMME_TAG, iProgrammeLen))
+    {
+      iNameLen = iProgrammeLen;
+      return iPos;
+    }
+    if (IsElementName(strName, iLength, XMLTV_CHANNEL_TAG, iChannelLen))
+    {
+      iNameLen = iChannelLen;
+      return iPos;
+    }
+    iPos++;
+  }
+
+  return std::string::npos;
+}
+
+size_t XmltvReader::FindElementEnd(size_t iStart, size_t iNameLen) const
+{
+  size_t iTagEnd = m_buffer.find('>', iStart);
+  if (iTagEnd == std::string::npos)
+    return std::string::npos;
+
+  // empty element
+  if (m_buffer[iTagEnd - 1] == '/')
+    return iTagEnd + 1;
+
+  std::string strEndTag = "</";
+  strEndTag.append(m_buffer, iStart + 1, iNameLen);
+  strEndTag.append(">");
+
+  size_t iEnd = m_buffer.find(strEndTag, iTagEnd);
+  if (iEnd == std::string::npos)
+    return std::string::npos;
+
+  return iEnd + strEndTag.length();
+}
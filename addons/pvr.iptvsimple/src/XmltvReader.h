@@ -0,0 +1,84 @@
+#pragma once
+/*
+ *      Copyright (C) 2013 Anton Fedchin
+ *      http://github.com/afedchin/xbmc-addon-iptvsimple/
+ *
+ *      Copyright (C) 2011 Pulse-Eight
+ *      http://www.pulse-eight.com/
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1301  USA
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <string>
+#include <vector>
+#include "zlib.h"
+#include "rapidxml/rapidxml.hpp"
+
+/*!
+ * @brief Pull parser for XMLTV files.
+ * The file is read in chunks and inflated on the fly when gzip packed. Each
+ * top level <channel> or <programme> element is parsed on its own, so memory
+ * use does not depend on the size of the guide.
+ */
+class XmltvReader
+{
+public:
+  XmltvReader(void);
+  virtual ~XmltvReader(void);
+
+  /*!
+   * @brief Open an XMLTV file.
+   * @param strPath The file to read.
+   * @param strCopyPath If not empty, raw file contents are copied to this file while reading.
+   * @return False if the file can't be opened or is empty.
+   */
+  bool Open(const std::string &strPath, const std::string &strCopyPath = "");
+  void Close(void);
+
+  /*!
+   * @brief Get the next <channel> or <programme> element.
+   * @return The element node, valid until the next call, or NULL at the end of file.
+   */
+  rapidxml::xml_node<> *NextElement(void);
+
+  /*!
+   * @return True if reading has been stopped by an I/O or inflate error.
+   */
+  bool IsError(void) const { return m_bError; }
+
+private:
+  bool   Fill(void);
+  bool   Decode(unsigned int iRead);
+  bool   IsMemberStart(void) const;
+  size_t FindElementStart(size_t iPos, size_t &iNameLen) const;
+  size_t FindElementEnd(size_t iStart, size_t iNameLen) const;
+
+  void                     *m_fileHandle;
+  void                     *m_copyHandle;
+  bool                      m_bGzip;
+  bool                      m_bEof;
+  bool                      m_bError;
+  bool                      m_bMemberEnd;
+  z_stream                  m_zStream;
+  std::vector<char>         m_readBuffer;
+  std::vector<char>         m_inflateBuffer;
+  std::string               m_buffer;
+  size_t                    m_iPos;
+  std::vector<char>         m_element;
+  rapidxml::xml_document<>  m_document;
+};
@@ -87,6 +87,36 @@ extern std::string GetUserFilePath(const std::string &strFileName)
   return PathCombine(g_strUserPath, strFileName);
 }
 
+void DeleteCacheFile(const std::string &strFile)
+{
+#ifdef TARGET_WINDOWS
+  DeleteFile(strFile.c_str());
+#else
+  XBMC->DeleteFile(strFile.c_str());
+#endif
+}
+
+void DeleteCacheFiles(const char *strFileName)
+{
+  std::string strFile = GetUserFilePath(strFileName);
+  if (XBMC->FileExists(strFile.c_str(), false))
+  {
+    DeleteCacheFile(strFile);
+  }
+
+  // caches of additional sources are named <name>.1, <name>.2 ...
+  for (int iSource = 1; ; iSource++)
+  {
+    char buff[16];
+    sprintf(buff, ".%d", iSource);
+    if (!XBMC->FileExists((strFile + buff).c_str(), false))
+    {
+      break;
+    }
+    DeleteCacheFile(strFile + buff);
+  }
+}
+
 extern "C" {
 
 void ADDON_ReadSettings(void)
@@ -244,25 +274,9 @@ ADDON_STATUS ADDON_SetSetting(const char *settingName, const void *settingValue)
 {
   // reset cache and restart addon 
 
-  string strFile = GetUserFilePath(M3U_FILE_NAME);
-  if (XBMC->FileExists(strFile.c_str(), false))
-  {
-#ifdef TARGET_WINDOWS
-    DeleteFile(strFile.c_str());
-#else
-    XBMC->DeleteFile(strFile.c_str());
-#endif
-  }
-
-  strFile = GetUserFilePath(TVG_FILE_NAME);
-  if (XBMC->FileExists(strFile.c_str(), false))
-  {
-#ifdef TARGET_WINDOWS
-    DeleteFile(strFile.c_str());
-#else
-    XBMC->DeleteFile(strFile.c_str());
-#endif
-  }
+  DeleteCacheFiles(M3U_FILE_NAME);
+  DeleteCacheFiles(TVG_FILE_NAME);
+  DeleteCacheFiles(EPG_FILE_NAME);
 
   return ADDON_STATUS_NEED_RESTART;
 }
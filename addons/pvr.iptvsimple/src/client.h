@@ -31,6 +31,7 @@
 #define PVR_CLIENT_VERSION     "1.9.3"
 #define M3U_FILE_NAME          "iptv.m3u.cache"
 #define TVG_FILE_NAME          "xmltv.xml.cache"
+#define EPG_FILE_NAME          "xmltv.epg.cache"
 
 /*!
  * @brief PVR macros for string exchange
@@ -101,16 +101,42 @@ time_t CDateTime::GetAsTime() const
   return retval;
 }
 
+// Reads the digits of a fixed width number, false when one of them is not a digit
+static bool ParseDigits(const char* str, int width, int& value)
+{
+  value = 0;
+  for (int i = 0; i < width; i++)
+  {
+    if (str[i] < '0' || str[i] > '9')
+      return false;
+    value = value * 10 + (str[i] - '0');
+  }
+  return true;
+}
+
 bool CDateTime::SetFromDateTime(const std::string& dateTime)
+{
+  return SetFromDateTime(dateTime.c_str());
+}
+
+bool CDateTime::SetFromDateTime(const char* dateTime)
 {
   int year, month ,day;
   int hour, minute, second;
-  int count;
-
-  count = sscanf(dateTime.c_str(), "%4d-%2d-%2d %2d:%2d:%2d", &year, &month, &day, &hour, &minute, &second);
 
-  if(count != 6)
-    return false;
+  // The server always sends "yyyy-mm-dd hh:mm:ss", parse that layout without sscanf
+  if (!ParseDigits(dateTime, 4, year) || dateTime[4] != '-' ||
+      !ParseDigits(dateTime + 5, 2, month) || dateTime[7] != '-' ||
+      !ParseDigits(dateTime + 8, 2, day) || dateTime[10] != ' ' ||
+      !ParseDigits(dateTime + 11, 2, hour) || dateTime[13] != ':' ||
+      !ParseDigits(dateTime + 14, 2, minute) || dateTime[16] != ':' ||
+      !ParseDigits(dateTime + 17, 2, second))
+  {
+    int count = sscanf(dateTime, "%4d-%2d-%2d %2d:%2d:%2d", &year, &month, &day, &hour, &minute, &second);
+
+    if(count != 6)
+      return false;
+  }
 
   m_time.tm_hour = hour;
   m_time.tm_min = minute;
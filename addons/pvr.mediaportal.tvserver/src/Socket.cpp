@@ -32,6 +32,7 @@ namespace MPTV
 
 /* Master defines for client control */
 #define RECEIVE_TIMEOUT 6 //sec
+#define RECEIVE_BUFFER_SIZE 16384
 
 Socket::Socket(const enum SocketFamily family, const enum SocketDomain domain, const enum SocketType type, const enum SocketProtocol protocol)
 {
@@ -41,6 +42,8 @@ Socket::Socket(const enum SocketFamily family, const enum SocketDomain domain, c
   _type = type;
   _protocol = protocol;
   memset (&_sockaddr, 0, sizeof( _sockaddr ) );
+  _readpos = 0;
+  _scanpos = 0;
 }
 
 
@@ -53,6 +56,8 @@ Socket::Socket()
   _type = sock_stream;
   _protocol = tcp;
   memset (&_sockaddr, 0, sizeof( _sockaddr ) );
+  _readpos = 0;
+  _scanpos = 0;
 }
 
 
@@ -94,11 +99,52 @@ bool Socket::close()
 #endif
     _sd = INVALID_SOCKET;
     osCleanup();
+    clearReadBuffer();
     return true;
   }
   return false;
 }
 
+void Socket::clearReadBuffer()
+{
+  _readbuffer.clear();
+  _readpos = 0;
+  _scanpos = 0;
+}
+
+// Drop the bytes already received by the socket without waiting for more,
+// false when the connection was closed meanwhile
+bool Socket::discardReceived()
+{
+  fd_set set_r;
+  struct timeval tv;
+  char   buffer[RECEIVE_BUFFER_SIZE];
+  int    discarded = 0;
+
+  while (true)
+  {
+    tv.tv_sec  = 0;
+    tv.tv_usec = 0;
+
+    FD_ZERO(&set_r);
+    FD_SET(_sd, &set_r);
+
+    if (select(FD_SETSIZE, &set_r, NULL, NULL, &tv) <= 0 || !FD_ISSET(_sd, &set_r))
+      break;
+
+    int result = recv(_sd, buffer, sizeof(buffer), 0);
+    if (result <= 0)
+      return false;
+    discarded += result;
+  }
+
+  if (discarded > 0)
+  {
+    XBMC->Log(LOG_DEBUG, "Socket::send  - discarding %i late bytes", discarded);
+  }
+  return true;
+}
+
 bool Socket::create()
 {
   if( is_valid() )
@@ -213,6 +259,21 @@ int Socket::send ( const char* data, const unsigned int len )
     return 0;
   }
 
+  // A new command must not pick up what is left of an earlier reply, neither
+  // buffered here nor still waiting in the socket after a read timeout
+  if (_readpos < _readbuffer.size())
+  {
+    XBMC->Log(LOG_DEBUG, "Socket::send  - discarding %i unread bytes", (int) (_readbuffer.size() - _readpos));
+  }
+  clearReadBuffer();
+
+  if (!discardReceived())
+  {
+    XBMC->Log(LOG_ERROR, "Socket::send  - connection closed by the server");
+    _sd = INVALID_SOCKET;
+    return 0;
+  }
+
   // fill with new data
   tv.tv_sec  = 0;
   tv.tv_usec = 0;
@@ -294,26 +355,34 @@ int Socket::receive ( std::string& data, unsigned int minpacketsize ) const
 }
 
 
-//Receive until error or \n
+//Receive until error or \r\n
 bool Socket::ReadLine (string& line)
 {
   fd_set         set_r, set_e;
   timeval        timeout;
   int            retries = 6;
-  char           buffer[2048];
+  char           buffer[RECEIVE_BUFFER_SIZE];
 
   if (!is_valid())
     return false;
 
   while (true)
   {
-    size_t pos1 = line.find("\r\n", 0);
+    // Only the newly received bytes are searched
+    size_t pos1 = _readbuffer.find("\r\n", _scanpos);
     if (pos1 != std::string::npos)
     {
-      line.erase(pos1, string::npos);
+      line.assign(_readbuffer, _readpos, pos1 - _readpos);
+      _readpos = pos1 + 2;
+      _scanpos = _readpos;
+      if (_readpos == _readbuffer.size())
+        clearReadBuffer();
       return true;
     }
 
+    // A trailing '\r' may be completed by the next packet
+    _scanpos = _readbuffer.size() > _readpos ? _readbuffer.size() - 1 : _readpos;
+
     timeout.tv_sec  = RECEIVE_TIMEOUT;
     timeout.tv_usec = 0;
 
@@ -329,6 +398,7 @@ bool Socket::ReadLine (string& line)
       XBMC->Log(LOG_DEBUG, "%s: select failed", __FUNCTION__);
       errormessage(getLastError(), __FUNCTION__);
       _sd = INVALID_SOCKET;
+      clearReadBuffer();
       return false;
     }
 
@@ -341,21 +411,36 @@ bool Socket::ReadLine (string& line)
         continue;
       } else {
          XBMC->Log(LOG_DEBUG, "%s: timeout waiting for response. Aborting after 10 retries.", __FUNCTION__);
+         clearReadBuffer();
          return false;
       }
     }
 
-    result = recv(_sd, buffer, sizeof(buffer) - 1, 0);
+    result = recv(_sd, buffer, sizeof(buffer), 0);
     if (result < 0)
     {
       XBMC->Log(LOG_DEBUG, "%s: recv failed", __FUNCTION__);
       errormessage(getLastError(), __FUNCTION__);
       _sd = INVALID_SOCKET;
+      clearReadBuffer();
+      return false;
+    }
+    if (result == 0)
+    {
+      XBMC->Log(LOG_DEBUG, "%s: connection closed by the server", __FUNCTION__);
+      _sd = INVALID_SOCKET;
+      clearReadBuffer();
       return false;
     }
-    buffer[result] = 0;
 
-    line.append(buffer);
+    // Drop the lines already returned before the buffer grows
+    if (_readpos > 0)
+    {
+      _readbuffer.erase(0, _readpos);
+      _scanpos -= _readpos;
+      _readpos = 0;
+    }
+    _readbuffer.append(buffer, result);
   }
 
   return true;
@@ -270,6 +270,14 @@ class Socket
 
     bool set_non_blocking ( const bool );
 
+    /*!
+     * Socket ReadLine function
+     * Read the next CRLF terminated line. Bytes received beyond it are kept
+     * for the next call, so several replies may be read after one send.
+     *
+     * \param line    Reference to a std::string that receives the line without the CRLF
+     * \return    True if a complete line was read
+     */
     bool ReadLine (string& line);
 
     bool is_valid() const;
@@ -284,6 +292,10 @@ class Socket
     enum SocketType _type;              ///< Socket Type
     enum SocketDomain _domain;          ///< Socket domain
 
+    std::string _readbuffer;            ///< Received data not returned by ReadLine yet
+    size_t _readpos;                    ///< Start of the unread data in _readbuffer
+    size_t _scanpos;                    ///< Position from where to look for the next CRLF
+
     #ifdef TARGET_WINDOWS
       WSADATA _wsaData;                 ///< Windows Socket data
       static int win_usage_count;       ///< Internal Windows usage counter used to prevent a global WSACleanup when more than one Socket object is used
@@ -293,6 +305,8 @@ class Socket
     int getLastError(void) const;
     bool osInit();
     void osCleanup();
+    void clearReadBuffer();
+    bool discardReceived();
 };
 
 } //namespace MPTV
@@ -63,11 +63,28 @@ bool cEpg::ParseLine(string& data)
 {
   try
   {
-    vector<string> epgfields;
+    // Locate the '|' separated fields in place instead of copying each of them into a vector
+    const char* epgfields[EPG_FIELD_COUNT];
+    size_t      fieldlengths[EPG_FIELD_COUNT];
+    size_t      fieldcount = 0;
+    size_t      start = 0;
 
-    Tokenize(data, epgfields, "|");
+    while (fieldcount < EPG_FIELD_COUNT)
+    {
+      size_t end = data.find('|', start);
+      if (end == string::npos)
+        end = data.length();
+
+      epgfields[fieldcount] = data.c_str() + start;
+      fieldlengths[fieldcount] = end - start;
+      fieldcount++;
+
+      if (end == data.length())
+        break;
+      start = end + 1;
+    }
 
-    if( epgfields.size() >= 5 )
+    if( fieldcount >= 5 )
     {
       //XBMC->Log(LOG_DEBUG, "%s: %s", epgfields[0].c_str(), epgfields[2].c_str());
       // field 0 = start date + time
@@ -88,39 +105,40 @@ bool cEpg::ParseLine(string& data)
 
       if( m_startTime.SetFromDateTime(epgfields[0]) == false )
       {
-        XBMC->Log(LOG_ERROR, "cEpg::ParseLine: Unable to convert start time '%s' into date+time", epgfields[0].c_str());
+        XBMC->Log(LOG_ERROR, "cEpg::ParseLine: Unable to convert start time '%.*s' into date+time", (int) fieldlengths[0], epgfields[0]);
         return false;
       }
 
       if( m_endTime.SetFromDateTime(epgfields[1]) == false )
       {
-        XBMC->Log(LOG_ERROR, "cEpg::ParseLine: Unable to convert end time '%s' into date+time", epgfields[1].c_str());
+        XBMC->Log(LOG_ERROR, "cEpg::ParseLine: Unable to convert end time '%.*s' into date+time", (int) fieldlengths[1], epgfields[1]);
         return false;
       }
 
       m_duration  = m_endTime - m_startTime;
 
-      m_title = epgfields[2];
-      m_description = epgfields[3];
-      m_shortText = epgfields[2];
-      m_genre = epgfields[4];
+      m_title.assign(epgfields[2], fieldlengths[2]);
+      m_description.assign(epgfields[3], fieldlengths[3]);
+      m_shortText.assign(epgfields[2], fieldlengths[2]);
+      m_genre.assign(epgfields[4], fieldlengths[4]);
       if (m_genretable) m_genretable->GenreToTypes(m_genre, m_genre_type, m_genre_subtype);
 
-      if( epgfields.size() >= 15 )
+      if( fieldcount >= 15 )
       {
         // Since TVServerXBMC v1.x.x.104
-        m_uid = (unsigned int) atol(epgfields[5].c_str());
-        m_seriesNumber = atoi(epgfields[7].c_str());
-        m_episodeNumber = atoi(epgfields[8].c_str());
-        m_episodeName = epgfields[9];
-        m_episodePart = epgfields[10];
-        m_starRating = atoi(epgfields[13].c_str());
-        m_parentalRating = atoi(epgfields[14].c_str());
+        // atol and atoi stop at the '|' ending the field
+        m_uid = (unsigned int) atol(epgfields[5]);
+        m_seriesNumber = atoi(epgfields[7]);
+        m_episodeNumber = atoi(epgfields[8]);
+        m_episodeName.assign(epgfields[9], fieldlengths[9]);
+        m_episodePart.assign(epgfields[10], fieldlengths[10]);
+        m_starRating = atoi(epgfields[13]);
+        m_parentalRating = atoi(epgfields[14]);
 
         //originalAirDate
         if( m_originalAirDate.SetFromDateTime(epgfields[11]) == false )
         {
-          XBMC->Log(LOG_ERROR, "cEpg::ParseLine: Unable to convert original air date '%s' into date+time", epgfields[11].c_str());
+          XBMC->Log(LOG_ERROR, "cEpg::ParseLine: Unable to convert original air date '%.*s' into date+time", (int) fieldlengths[11], epgfields[11]);
           return false;
         }
       }
@@ -33,6 +33,9 @@
 
 using namespace std;
 
+// Number of '|' separated fields in an EPG record, see cEpg::ParseLine
+#define EPG_FIELD_COUNT 15
+
 class cEpg
 {
 private:
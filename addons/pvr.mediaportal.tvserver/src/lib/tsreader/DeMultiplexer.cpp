@@ -188,8 +188,6 @@ int CDeMultiplexer::ReadFromFile()
 ///  - decode any audio/video packets and put the PES packets in the appropiate buffers
 void CDeMultiplexer::OnTsPacket(byte* tsPacket)
 {
-  CTsHeader header(tsPacket);
-
   m_patParser.OnTsPacket(tsPacket);
 
   if (m_iPatVersion==-1)
@@ -214,6 +212,13 @@ void CDeMultiplexer::OnTsPacket(byte* tsPacket)
   }
 }
 
+/// This method gets called via ReadFile() with a run of TS packets that are in sync
+void CDeMultiplexer::OnTsPackets(byte* tsPackets, int count)
+{
+  for (int i = 0; i < count; i++)
+    CDeMultiplexer::OnTsPacket(&tsPackets[i * TS_PACKET_LEN]);
+}
+
 void CDeMultiplexer::RequestNewPat(void)
 {
   m_ReqPatVersion++;
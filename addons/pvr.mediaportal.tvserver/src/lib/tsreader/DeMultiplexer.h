@@ -33,7 +33,7 @@
  */
 #pragma once
 
-#include "MultiFileReader.h"
+#include "tsreader/MultiFileReader.h"
 #include "PacketSync.h"
 #include "TSHeader.h"
 #include "PatParser.h"
@@ -50,6 +50,7 @@ public:
 
   void       Start();
   void       OnTsPacket(byte* tsPacket);
+  void       OnTsPackets(byte* tsPackets, int count);
   void       OnNewChannel(CChannelInfo& info);
   void       SetFileReader(FileReader* reader);
   void RequestNewPat(void);
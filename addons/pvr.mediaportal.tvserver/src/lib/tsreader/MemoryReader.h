@@ -30,7 +30,7 @@
 
 #ifdef LIVE555
 
-#include "FileReader.h"
+#include "tsreader/FileReader.h"
 #include "MemoryBuffer.h"
 #include "utils.h"
 
@@ -56,27 +56,45 @@ void CPacketSync::OnRawData(byte* pData, int nDataLen)
 
   while (syncOffset + TS_PACKET_LEN < nDataLen)
   {
-    if ((pData[syncOffset] == TS_PACKET_SYNC) &&
-        (pData[syncOffset + TS_PACKET_LEN] == TS_PACKET_SYNC))
+    if (pData[syncOffset] == TS_PACKET_SYNC)
+    {
+      // Take every packet followed by a sync byte in one go
+      int count = 0;
+      int next = syncOffset + TS_PACKET_LEN;
+      while ((next < nDataLen) && (pData[next] == TS_PACKET_SYNC))
+      {
+        count++;
+        next += TS_PACKET_LEN;
+      }
+      if (count > 0)
+      {
+        OnTsPackets(&pData[syncOffset], count);
+        syncOffset += count * TS_PACKET_LEN;
+        continue;
+      }
+    }
+
+    // Lost sync, skip to the next candidate sync byte
+    byte* pSync = (byte*) memchr(&pData[syncOffset + 1], TS_PACKET_SYNC, nDataLen - TS_PACKET_LEN - syncOffset - 1);
+    if (pSync == NULL)
     {
-      OnTsPacket( &pData[syncOffset] );
-      syncOffset += TS_PACKET_LEN;
+      syncOffset = nDataLen - TS_PACKET_LEN;
+      break;
     }
-    else
-      syncOffset++;
+    syncOffset = (int) (pSync - pData);
   }
 
   // Here we have less than 188+1 bytes
-  while (syncOffset < nDataLen)
+  if (syncOffset < nDataLen)
   {
-    if (pData[syncOffset] == TS_PACKET_SYNC)
+    byte* pSync = (byte*) memchr(&pData[syncOffset], TS_PACKET_SYNC, nDataLen - syncOffset);
+    if (pSync != NULL)
     {
+      syncOffset = (int) (pSync - pData);
       m_tempBufferPos = nDataLen - syncOffset;
       memcpy( m_tempBuffer, &pData[syncOffset], m_tempBufferPos );
       return;
     }
-    else
-      syncOffset++;
   }
 
   m_tempBufferPos = 0 ;
@@ -85,3 +103,9 @@ void CPacketSync::OnRawData(byte* pData, int nDataLen)
 void CPacketSync::OnTsPacket(byte* UNUSED(tsPacket))
 {
 }
+
+void CPacketSync::OnTsPackets(byte* tsPackets, int count)
+{
+  for (int i = 0; i < count; i++)
+    OnTsPacket(&tsPackets[i * TS_PACKET_LEN]);
+}
@@ -35,6 +35,8 @@ public:
   virtual ~CPacketSync(void);
   void OnRawData(byte* pData, int nDataLen);
   virtual void OnTsPacket(byte* tsPacket);
+  // Called with a run of count consecutive packets, defaults to one OnTsPacket per packet
+  virtual void OnTsPackets(byte* tsPackets, int count);
   void Reset(void);
 
 private:
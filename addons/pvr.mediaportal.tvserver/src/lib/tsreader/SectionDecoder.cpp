@@ -80,6 +80,12 @@ void CSectionDecoder::OnTsPacket(byte* tsPacket)
   if (tsPacket == NULL)
     return;
 
+  // Most packets belong to other pids, skip those before decoding the whole header.
+  // Invalid packets still go through, they reset the section being collected.
+  if ((tsPacket[0] == 0x47) && ((tsPacket[1] & 0x80) == 0) &&
+      ((((tsPacket[1] & 0x1F) << 8) + tsPacket[2]) != m_pid))
+    return;
+
   m_header.Decode(tsPacket);
   OnTsPacket(m_header,tsPacket);
 }
@@ -29,9 +29,9 @@
 
 #include "TSReader.h"
 #include "client.h" //for XBMC->Log
-#include "MultiFileReader.h"
+#include "tsreader/MultiFileReader.h"
 #include "utils.h"
-#include "TSDebug.h"
+#include "tsreader/TSDebug.h"
 #include "platform/util/timeutils.h"
 #ifdef LIVE555
 #include "MemoryReader.h"
@@ -295,6 +295,16 @@ long CTsReader::Read(unsigned char* pbData, unsigned long lDataLength, unsigned
   return S_FALSE;
 }
 
+bool CTsReader::WaitForData(unsigned long dwTimeoutMs)
+{
+  if (m_fileReader)
+  {
+    return m_fileReader->WaitForData(dwTimeoutMs);
+  }
+
+  return false;
+}
+
 void CTsReader::Close()
 {
   if (m_fileReader)
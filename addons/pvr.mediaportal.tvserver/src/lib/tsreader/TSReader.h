@@ -29,7 +29,7 @@
  *************************************************************************/
 
 #include "client.h"
-#include "FileReader.h"
+#include "tsreader/FileReader.h"
 #include "platform/util/StdString.h"
 #include "DeMultiplexer.h"
 #include "Cards.h"
@@ -52,6 +52,13 @@ public:
   ~CTsReader(void);
   long Open(const char* pszFileName);
   long Read(unsigned char* pbData, unsigned long lDataLength, unsigned long *dwReadBytes);
+
+  /**
+   * \brief Wait until the stream has data beyond the read position
+   * \param dwTimeoutMs the maximum time to wait in msec
+   * \return true when there may be data to read
+   */
+  bool WaitForData(unsigned long dwTimeoutMs);
   void Close();
   int64_t SetFilePointer(int64_t llDistanceToMove, unsigned long dwMoveMethod);
   int64_t GetFileSize();
@@ -51,6 +51,9 @@ int g_iTVServerXBMCBuild = 0;
 #define TVSERVERXBMC_RECOMMENDED_VERSION_STRING "1.2.3.122, 1.3.0.122, 1.4.0.124, 1.5.0.125 or 1.6.0.126"
 #define TVSERVERXBMC_RECOMMENDED_VERSION_BUILD  122
 
+/* Maximum time in msec that ReadLiveStream waits for the timeshift buffer to grow */
+#define READ_LIVE_STREAM_TIMEOUT                2000
+
 /************************************************************/
 /** Class interface */
 
@@ -162,6 +165,56 @@ bool cPVRClientMediaPortal::SendCommand2(string command, vector<string>& lines)
   return true;
 }
 
+/* SendCommands()
+ * \brief   Send several commands in one go and read their replies, this costs one round
+ *          trip to the TVServer instead of one per command
+ * \return  True when all replies were received
+ */
+bool cPVRClientMediaPortal::SendCommands(const vector<string>& commands, vector<string>& replies)
+{
+  PLATFORM::CLockObject critsec(m_mutex);
+  string command;
+
+  for (vector<string>::const_iterator it = commands.begin(); it != commands.end(); ++it)
+    command += *it;
+
+  if ( !m_tcpclient->send(command) )
+  {
+    if ( !m_tcpclient->is_valid() )
+    {
+      // Connection lost, try to reconnect
+      if ( Connect() == ADDON_STATUS_OK )
+      {
+        // Resend the commands
+        if (!m_tcpclient->send(command))
+        {
+          XBMC->Log(LOG_ERROR, "SendCommands('%s') failed.", command.c_str());
+          return false;
+        }
+      }
+      else
+      {
+        XBMC->Log(LOG_ERROR, "SendCommands: reconnect failed.");
+        return false;
+      }
+    }
+  }
+
+  replies.clear();
+  replies.resize(commands.size());
+
+  for (size_t i = 0; i < commands.size(); i++)
+  {
+    if ( !m_tcpclient->ReadLine( replies[i] ) )
+    {
+      XBMC->Log(LOG_ERROR, "SendCommands - Failed.");
+      return false;
+    }
+  }
+
+  return true;
+}
+
 ADDON_STATUS cPVRClientMediaPortal::Connect()
 {
   string result;
@@ -242,7 +295,7 @@ ADDON_STATUS cPVRClientMediaPortal::Connect()
 
   /* Load additional settings */
   LoadGenreTable();
-  LoadCardSettings();
+  LoadBackendSettings();
 
   /* The pvr addon cannot access XBMC's current locale settings, so just use the system default */
   setlocale(LC_ALL, "");
@@ -318,9 +371,27 @@ const char* cPVRClientMediaPortal::GetBackendName(void)
 
   if (m_BackendName.length() == 0)
   {
-    m_BackendName = "MediaPortal TV-server (";
-    m_BackendName += SendCommand("GetBackendName:\n");
-    m_BackendName += ")";
+    // Both are shown together, fetch the version in the same round trip
+    vector<string> commands;
+    vector<string> replies;
+
+    commands.push_back("GetBackendName:\n");
+    if (m_BackendVersion.length() == 0)
+      commands.push_back("GetVersion:\n");
+
+    if (SendCommands(commands, replies))
+    {
+      m_BackendName = "MediaPortal TV-server (";
+      m_BackendName += replies[0];
+      m_BackendName += ")";
+
+      if (replies.size() > 1)
+        m_BackendVersion = replies[1];
+    }
+    else
+    {
+      return g_szHostname.c_str();
+    }
   }
 
   return m_BackendName.c_str();
@@ -443,9 +514,9 @@ PVR_ERROR cPVRClientMediaPortal::GetBackendTime(time_t *localTime, int *gmtOffse
 
 PVR_ERROR cPVRClientMediaPortal::GetEpg(ADDON_HANDLE handle, const PVR_CHANNEL &channel, time_t iStart, time_t iEnd)
 {
-  vector<string> lines;
   char           command[256];
   string         result;
+  string         data;
   cEpg           epg;
   EPG_TAG        broadcast;
   struct tm      starttime;
@@ -474,26 +545,30 @@ PVR_ERROR cPVRClientMediaPortal::GetEpg(ADDON_HANDLE handle, const PVR_CHANNEL &
       memset(&broadcast, 0, sizeof(EPG_TAG));
       epg.SetGenreTable(m_genretable);
 
-      Tokenize(result, lines, ",");
-
-      XBMC->Log(LOG_DEBUG, "Found %i EPG items for channel %i\n", lines.size(), channel.iUniqueId);
+      // Walk the ',' separated records in the reply and hand over each one once parsed
+      int    count = 0;
+      size_t start = 0;
 
-      for (vector<string>::iterator it = lines.begin(); it < lines.end(); ++it)
+      while (start < result.length())
       {
-        string& data(*it);
+        size_t end = result.find(',', start);
+        if (end == string::npos)
+          end = result.length();
 
-        if( data.length() > 0)
+        if (end > start)
         {
+          data.assign(result, start, end - start);
           uri::decode(data);
 
           bool isEnd = epg.ParseLine(data);
+          time_t startTime = epg.StartTime();
 
-          if (isEnd && epg.StartTime() != 0)
+          if (isEnd && startTime != 0)
           {
             broadcast.iUniqueBroadcastId  = epg.UniqueId();
             broadcast.strTitle            = epg.Title();
             broadcast.iChannelNumber      = channel.iChannelNumber;
-            broadcast.startTime           = epg.StartTime();
+            broadcast.startTime           = startTime;
             broadcast.endTime             = epg.EndTime();
             broadcast.strPlotOutline      = epg.ShortText();
             broadcast.strPlot             = epg.Description();
@@ -513,8 +588,12 @@ PVR_ERROR cPVRClientMediaPortal::GetEpg(ADDON_HANDLE handle, const PVR_CHANNEL &
             PVR->TransferEpgEntry(handle, &broadcast);
           }
           epg.Reset();
+          count++;
         }
+        start = end + 1;
       }
+
+      XBMC->Log(LOG_DEBUG, "Found %i EPG items for channel %i\n", count, channel.iUniqueId);
     }
     else
     {
@@ -1583,7 +1662,6 @@ int cPVRClientMediaPortal::ReadLiveStream(unsigned char *pBuffer, unsigned int i
 {
   unsigned long read_wanted = iBufferSize;
   unsigned long read_done   = 0;
-  static int read_timeouts  = 0;
   unsigned char* bufptr = pBuffer;
 
   //XBMC->Log(LOG_DEBUG, "->ReadLiveStream(buf_size=%i)", buf_size);
@@ -1599,6 +1677,8 @@ int cPVRClientMediaPortal::ReadLiveStream(unsigned char *pBuffer, unsigned int i
     return -1;
   }
 
+  PLATFORM::CTimeout timeout(READ_LIVE_STREAM_TIMEOUT);
+
   while (read_done < (unsigned long) iBufferSize)
   {
     read_wanted = iBufferSize - read_done;
@@ -1606,17 +1686,18 @@ int cPVRClientMediaPortal::ReadLiveStream(unsigned char *pBuffer, unsigned int i
     if (m_tsreader->Read(bufptr, read_wanted, &read_wanted) > 0)
     {
       usleep(400000);
-      read_timeouts++;
       return read_wanted;
     }
     read_done += read_wanted;
 
     if ( read_done < (unsigned long) iBufferSize )
     {
-      if (read_timeouts > 50)
+      bufptr += read_wanted;
+
+      // At the live edge: continue as soon as the timeshift buffer has grown
+      if (!m_tsreader->WaitForData(timeout.TimeLeft()))
       {
-        XBMC->Log(LOG_NOTICE, "XBMC requested %u bytes, but the TSReader got only %ul bytes in 2 seconds", iBufferSize, read_done);
-        read_timeouts = 0;
+        XBMC->Log(LOG_NOTICE, "XBMC requested %u bytes, but the TSReader got only %lu bytes in %d msec", iBufferSize, read_done, READ_LIVE_STREAM_TIMEOUT);
 
         //TODO
         //if read_done == 0 then check if the backend is still timeshifting,
@@ -1624,12 +1705,8 @@ int cPVRClientMediaPortal::ReadLiveStream(unsigned char *pBuffer, unsigned int i
 
         return read_done;
       }
-      bufptr += read_wanted;
-      read_timeouts++;
-      usleep(40000);
     }
   }
-  read_timeouts = 0;
 
   return read_done;
 }
@@ -1990,15 +2067,35 @@ void cPVRClientMediaPortal::LoadGenreTable()
   }
 }
 
-void cPVRClientMediaPortal::LoadCardSettings()
+void cPVRClientMediaPortal::LoadBackendSettings()
 {
   XBMC->Log(LOG_DEBUG, "Loading card settings");
 
-  /* Retrieve card settings (needed for Live TV and recordings folders) */
-  vector<string> lines;
+  /* Retrieve card settings (needed for Live TV and recordings folders) together
+     with the backend name and version, in a single round trip */
+  vector<string> commands;
+  vector<string> replies;
 
-  if ( SendCommand2("GetCardSettings\n", lines) )
+  commands.push_back("GetCardSettings\n");
+  commands.push_back("GetBackendName:\n");
+  commands.push_back("GetVersion:\n");
+
+  if (!SendCommands(commands, replies))
+    return;
+
+  if (replies[0].find("[ERROR]:") != std::string::npos)
+  {
+    XBMC->Log(LOG_ERROR, "TVServerXBMC error: %s", replies[0].c_str());
+  }
+  else
   {
+    vector<string> lines;
+    Tokenize(replies[0], lines, ",");
     m_cCards.ParseLines(lines);
   }
+
+  m_BackendName = "MediaPortal TV-server (";
+  m_BackendName += replies[1];
+  m_BackendName += ")";
+  m_BackendVersion = replies[2];
 }
@@ -111,7 +111,7 @@ protected:
 private:
   bool GetChannel(unsigned int number, PVR_CHANNEL &channeldata);
   void LoadGenreTable(void);
-  void LoadCardSettings(void);
+  void LoadBackendSettings(void);
 
   int                     m_iCurrentChannel;
   int                     m_iCurrentCard;
@@ -139,4 +139,5 @@ private:
   //Used for TV Server communication:
   std::string SendCommand(std::string command);
   bool SendCommand2(std::string command, std::vector<std::string>& lines);
+  bool SendCommands(const std::vector<std::string>& commands, std::vector<std::string>& replies);
 };
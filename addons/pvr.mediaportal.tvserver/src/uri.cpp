@@ -196,26 +196,32 @@ namespace uri
       return true;
     }
 
-    std::string v;
-    for (size_t i = 0;;)
+    // Check all escapes first, s is left as is when one is invalid.
+    char c;
+    for (size_t i = pos; i != std::string::npos; i = s.find(ENCODE_BEGIN_CHAR, i + 3))
     {
-      if (pos == std::string::npos)
+      if (!parse_hex(s, i + 1, c))
       {
-        v.append(s, i, s.size() - i); // Append up to end.
-        break;
+        return false;
+      }
+    }
+
+    // Decode in place, the result is never longer than the input.
+    size_t out = pos;
+    for (size_t i = pos; i < s.size();)
+    {
+      if (s[i] == ENCODE_BEGIN_CHAR)
+      {
+        parse_hex(s, i + 1, c); // Convert hex.
+        s[out++] = c;
+        i += 3; // Skip all 3 chars.
       }
-      v.append(s, i, pos - i); // Append up to char.
-      i = pos + 3; // Skip all 3 chars.
-      char c;
-      if (!parse_hex(s, pos + 1, c))
+      else
       {
-        // Convert hex.
-        return false;
+        s[out++] = s[i++];
       }
-      v.insert(v.end(), c); // Append converted hex.
-      pos = s.find(ENCODE_BEGIN_CHAR, i); // Find next
     }
-    s = v;
+    s.resize(out);
     return true;
   }
 } //namespace URI
@@ -92,7 +92,7 @@ void ES_MPEG2Video::Parse(STREAM_PKT *pkt)
         break;
       }
     }
-    startcode = startcode << 8 | es_buf[p++];
+    p = NextStartCode(p, startcode);
   }
   es_parsed = p;
   m_StartCode = startcode;
@@ -82,7 +82,7 @@ void ES_h264::Parse(STREAM_PKT* pkt)
         break;
       }
     }
-    startcode = startcode << 8 | es_buf[p++];
+    p = NextStartCode(p, startcode);
   }
   es_parsed = p;
   m_StartCode = startcode;
@@ -0,0 +1,570 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <stdlib.h>
+
+#include "ES_hevc.h"
+#include "bitstream.h"
+
+#define HEVC_MAX_PS_SIZE  1024
+
+/*
+ * Copy a NAL payload into dst removing the emulation prevention bytes
+ * (00 00 03), so the RBSP can be read with cBitstream.
+ */
+static int nal_unescape(uint8_t *dst, const uint8_t *src, int len)
+{
+  int d = 0;
+  int zeros = 0;
+  for (int i = 0; i < len; i++)
+  {
+    if (zeros >= 2 && src[i] == 0x03)
+    {
+      zeros = 0;
+      continue;
+    }
+    dst[d++] = src[i];
+    zeros = (src[i] ? 0 : zeros + 1);
+  }
+  return d;
+}
+
+ES_hevc::ES_hevc(uint16_t pes_pid)
+ : ElementaryStream(pes_pid)
+{
+  m_Height                      = 0;
+  m_Width                       = 0;
+  m_FpsScale                    = 0;
+  m_ParNum                      = 0;
+  m_ParDen                      = 1;
+  m_DTS                         = 0;
+  m_PTS                         = 0;
+  m_Interlaced                  = false;
+  es_alloc_init                 = 400000;
+  Reset();
+}
+
+ES_hevc::~ES_hevc()
+{
+}
+
+void ES_hevc::Parse(STREAM_PKT* pkt)
+{
+  int frame_ptr = es_consumed;
+  int p = es_parsed;
+  uint32_t startcode = m_StartCode;
+  bool frameComplete = false;
+  int l;
+  while ((l = es_len - p) > 3)
+  {
+    if ((startcode & 0xffffff00) == 0x00000100)
+    {
+      if (Parse_HEVC(startcode, p, frameComplete) < 0)
+      {
+        break;
+      }
+    }
+    p = NextStartCode(p, startcode);
+  }
+  es_parsed = p;
+  m_StartCode = startcode;
+
+  if (frameComplete)
+  {
+    if (!m_NeedSPS && !m_NeedIFrame)
+    {
+      double PAR = (double)m_ParNum/(double)m_ParDen;
+      double DAR = (PAR * m_Width) / m_Height;
+      demux_dbg(DEMUX_DBG_PARSE, "HEVC SPS: PAR %i:%i\n", m_ParNum, m_ParDen);
+      demux_dbg(DEMUX_DBG_PARSE, "HEVC SPS: DAR %.2f\n", DAR);
+      if (m_FpsScale == 0)
+      {
+        m_FpsScale = static_cast<int>(Rescale(c_dts - p_dts, RESCALE_TIME_BASE, PTS_TIME_BASE));
+      }
+      bool streamChange = SetVideoInformation(m_FpsScale, RESCALE_TIME_BASE, m_Height, m_Width, static_cast<float>(DAR), m_Interlaced);
+      pkt->pid            = pid;
+      pkt->size           = es_consumed - frame_ptr;
+      pkt->data           = &es_buf[frame_ptr];
+      pkt->dts            = m_DTS;
+      pkt->pts            = m_PTS;
+      pkt->duration       = c_dts - p_dts;
+      pkt->streamChange   = streamChange;
+    }
+    m_StartCode = 0xffffffff;
+    es_parsed = es_consumed;
+    es_found_frame = false;
+  }
+}
+
+void ES_hevc::Reset()
+{
+  ElementaryStream::Reset();
+  m_StartCode = 0xffffffff;
+  m_NeedIFrame = true;
+  m_NeedVPS = true;
+  m_NeedSPS = true;
+  m_NeedPPS = true;
+  memset(&m_streamData, 0, sizeof(m_streamData));
+}
+
+int ES_hevc::Parse_HEVC(uint32_t startcode, int buf_ptr, bool &complete)
+{
+  // The start code holds the first byte of the 2 bytes NAL unit header:
+  // buf[0] is the second one and the payload begins at buf[1]
+  int len = es_len - buf_ptr;
+  uint8_t *buf = es_buf + buf_ptr;
+  int nal_unit_type = (startcode >> 1) & 0x3f;
+
+  // VCL NAL units
+  if (nal_unit_type < NAL_VPS)
+  {
+    if (m_NeedVPS || m_NeedSPS || m_NeedPPS)
+    {
+      es_found_frame = true;
+      return 0;
+    }
+    // need at least 32 bytes for parsing slice segment header
+    if (len < 32)
+      return -1;
+    bool first_slice;
+    if (!Parse_SLH(buf + 1, len - 1, nal_unit_type, first_slice))
+      return 0;
+
+    // check for the beginning of a new access unit
+    if (es_found_frame && first_slice)
+    {
+      complete = true;
+      es_consumed = buf_ptr - 4;
+      return -1;
+    }
+
+    if (nal_unit_type >= NAL_BLA_W_LP && nal_unit_type <= NAL_RSV_IRAP_23)
+      m_NeedIFrame = false;
+
+    if (!es_found_frame)
+    {
+      if (buf_ptr - 4 >= (int)es_pts_pointer)
+      {
+        m_DTS = c_dts;
+        m_PTS = c_pts;
+      }
+      else
+      {
+        m_DTS = p_dts;
+        m_PTS = p_pts;
+      }
+    }
+
+    es_found_frame = true;
+    return 0;
+  }
+
+  switch (nal_unit_type)
+  {
+  case NAL_VPS:
+    if (es_found_frame)
+    {
+      complete = true;
+      es_consumed = buf_ptr - 4;
+      return -1;
+    }
+    m_NeedVPS = false;
+    break;
+
+  case NAL_SPS:
+  {
+    if (es_found_frame)
+    {
+      complete = true;
+      es_consumed = buf_ptr - 4;
+      return -1;
+    }
+    // the SPS is complete once the next start code is buffered, or once
+    // there is more than Parse_SPS() ever reads
+    uint32_t next_startcode = 0xffffffff;
+    int sps_len = NextStartCode(buf_ptr, next_startcode) - 4 - buf_ptr;
+    if ((next_startcode & 0xffffff00) != 0x00000100)
+    {
+      if (len < HEVC_MAX_PS_SIZE)
+        return -1;
+      sps_len = len;
+    }
+    if (sps_len < 2 || !Parse_SPS(buf + 1, sps_len - 1))
+      return 0;
+
+    m_NeedSPS = false;
+    break;
+  }
+
+  case NAL_PPS:
+  {
+    if (es_found_frame)
+    {
+      complete = true;
+      es_consumed = buf_ptr - 4;
+      return -1;
+    }
+    if (len < 16)
+      return -1;
+    if (!Parse_PPS(buf + 1, len - 1))
+      return 0;
+    m_NeedPPS = false;
+    break;
+  }
+
+  case NAL_AUD:
+  case NAL_SEI_PREFIX:
+  case 41:
+  case 42:
+  case 43:
+  case 44:
+  case 48:
+  case 49:
+  case 50:
+  case 51:
+  case 52:
+  case 53:
+  case 54:
+  case 55:
+    if (es_found_frame)
+    {
+      complete = true;
+      es_consumed = buf_ptr - 4;
+      return -1;
+    }
+    break;
+
+  case NAL_EOS:
+  case NAL_EOB:
+    if (es_found_frame)
+    {
+      complete = true;
+      es_consumed = buf_ptr + 1;
+      return -1;
+    }
+    break;
+
+  default:
+    break;
+  }
+
+  return 0;
+}
+
+bool ES_hevc::Parse_PPS(uint8_t *buf, int len)
+{
+  uint8_t rbsp[16];
+  int rbsp_len = nal_unescape(rbsp, buf, len < 16 ? len : 16);
+  cBitstream bs(rbsp, rbsp_len*8);
+
+  unsigned int pps_id = bs.readGolombUE();
+  unsigned int sps_id = bs.readGolombUE();
+  if (bs.isError() || pps_id > 63 || sps_id > 15)
+    return false;
+  m_streamData.pps[pps_id].sps = sps_id;
+  return true;
+}
+
+bool ES_hevc::Parse_SLH(uint8_t *buf, int len, int nal_unit_type, bool &first_slice)
+{
+  cBitstream bs(buf, len*8);
+
+  first_slice = bs.readBits1();  /* first_slice_segment_in_pic_flag */
+  if (nal_unit_type >= NAL_BLA_W_LP && nal_unit_type <= NAL_RSV_IRAP_23)
+    bs.skipBits(1);              /* no_output_of_prior_pics_flag    */
+  unsigned int pps_id = bs.readGolombUE();
+  if (pps_id > 63)
+    return false;
+
+  hevc_private::SPS &sps = m_streamData.sps[m_streamData.pps[pps_id].sps];
+  if (!sps.valid)
+    return false;
+
+  m_Width = sps.width;
+  m_Height = sps.height;
+  m_Interlaced = (sps.interlaced != 0);
+  m_ParNum = sps.par_num;
+  m_ParDen = sps.par_den;
+  if (sps.fps_scale)
+    m_FpsScale = sps.fps_scale;
+  return true;
+}
+
+bool ES_hevc::Parse_SPS(uint8_t *buf, int len)
+{
+  uint8_t rbsp[HEVC_MAX_PS_SIZE];
+  int rbsp_len = nal_unescape(rbsp, buf, len < HEVC_MAX_PS_SIZE ? len : HEVC_MAX_PS_SIZE);
+  cBitstream bs(rbsp, rbsp_len*8);
+  bool interlaced = false;
+
+  bs.skipBits(4);                                  /* sps_video_parameter_set_id   */
+  int max_sub_layers_minus1 = bs.readBits(3);
+  bs.skipBits(1);                                  /* sps_temporal_id_nesting_flag */
+  Parse_PTL(bs, max_sub_layers_minus1, interlaced);
+  unsigned int seq_parameter_set_id = bs.readGolombUE();
+  if (seq_parameter_set_id > 15)
+    return false;
+
+  int chroma_format_idc = bs.readGolombUE();
+  int separate_colour_plane = 0;
+  if (chroma_format_idc == 3)
+    separate_colour_plane = bs.readBits1();
+  int width  = bs.readGolombUE();                  /* pic_width_in_luma_samples    */
+  int height = bs.readGolombUE();                  /* pic_height_in_luma_samples   */
+  if (bs.readBits1())                              /* conformance_window_flag      */
+  {
+    int sub_width = ((chroma_format_idc == 1 || chroma_format_idc == 2) && !separate_colour_plane) ? 2 : 1;
+    int sub_height = (chroma_format_idc == 1 && !separate_colour_plane) ? 2 : 1;
+    uint32_t crop_left   = bs.readGolombUE();
+    uint32_t crop_right  = bs.readGolombUE();
+    uint32_t crop_top    = bs.readGolombUE();
+    uint32_t crop_bottom = bs.readGolombUE();
+    demux_dbg(DEMUX_DBG_PARSE, "HEVC SPS: cropping %d %d %d %d\n", crop_left, crop_top, crop_right, crop_bottom);
+
+    width -= sub_width * (crop_left + crop_right);
+    height -= sub_height * (crop_top + crop_bottom);
+  }
+  bs.readGolombUE();                               /* bit_depth_luma_minus8        */
+  bs.readGolombUE();                               /* bit_depth_chroma_minus8      */
+  int log2_max_pic_order_cnt_lsb = bs.readGolombUE() + 4;
+  int sub_layer_ordering_info_present = bs.readBits1();
+  for (int i = (sub_layer_ordering_info_present ? 0 : max_sub_layers_minus1); i <= max_sub_layers_minus1; i++)
+  {
+    bs.readGolombUE();                             /* sps_max_dec_pic_buffering_minus1 */
+    bs.readGolombUE();                             /* sps_max_num_reorder_pics         */
+    bs.readGolombUE();                             /* sps_max_latency_increase_plus1   */
+  }
+  bs.readGolombUE();                               /* log2_min_luma_coding_block_size_minus3      */
+  bs.readGolombUE();                               /* log2_diff_max_min_luma_coding_block_size    */
+  bs.readGolombUE();                               /* log2_min_luma_transform_block_size_minus2   */
+  bs.readGolombUE();                               /* log2_diff_max_min_luma_transform_block_size */
+  bs.readGolombUE();                               /* max_transform_hierarchy_depth_inter         */
+  bs.readGolombUE();                               /* max_transform_hierarchy_depth_intra         */
+  if (bs.readBits1())                              /* scaling_list_enabled_flag            */
+  {
+    if (bs.readBits1())                            /* sps_scaling_list_data_present_flag   */
+    {
+      for (int size_id = 0; size_id < 4; size_id++)
+      {
+        for (int matrix_id = 0; matrix_id < 6; matrix_id += (size_id == 3) ? 3 : 1)
+        {
+          if (!bs.readBits1())                     /* scaling_list_pred_mode_flag          */
+            bs.readGolombUE();                     /* scaling_list_pred_matrix_id_delta    */
+          else
+          {
+            int coef_num = (size_id == 0) ? 16 : 64;
+            if (size_id > 1)
+              bs.readGolombSE();                   /* scaling_list_dc_coef_minus8          */
+            for (int i = 0; i < coef_num; i++)
+              bs.readGolombSE();                   /* scaling_list_delta_coef              */
+          }
+        }
+      }
+    }
+  }
+  bs.skipBits(1);                                  /* amp_enabled_flag                     */
+  bs.skipBits(1);                                  /* sample_adaptive_offset_enabled_flag  */
+  if (bs.readBits1())                              /* pcm_enabled_flag                     */
+  {
+    bs.skipBits(4);                                /* pcm_sample_bit_depth_luma_minus1     */
+    bs.skipBits(4);                                /* pcm_sample_bit_depth_chroma_minus1   */
+    bs.readGolombUE();                             /* log2_min_pcm_luma_coding_block_size_minus3 */
+    bs.readGolombUE();                             /* log2_diff_max_min_pcm_luma_coding_block_size */
+    bs.skipBits(1);                                /* pcm_loop_filter_disabled_flag        */
+  }
+  unsigned int num_short_term_ref_pic_sets = bs.readGolombUE();
+  if (num_short_term_ref_pic_sets > 64)
+    return false;
+  int num_delta_pocs[64];
+  for (unsigned int i = 0; i < num_short_term_ref_pic_sets; i++)
+  {
+    if (!Parse_ST_RPS(bs, i, num_delta_pocs))
+      return false;
+  }
+  if (bs.readBits1())                              /* long_term_ref_pics_present_flag      */
+  {
+    unsigned int num_long_term_ref_pics_sps = bs.readGolombUE();
+    if (num_long_term_ref_pics_sps > 32)
+      return false;
+    for (unsigned int i = 0; i < num_long_term_ref_pics_sps; i++)
+      bs.skipBits(log2_max_pic_order_cnt_lsb + 1); /* lt_ref_pic_poc_lsb_sps, used_by_curr_pic_lt_sps_flag */
+  }
+  bs.skipBits(1);                                  /* sps_temporal_mvp_enabled_flag        */
+  bs.skipBits(1);                                  /* strong_intra_smoothing_enabled_flag  */
+
+  /* VUI parameters */
+  int par_num = 0;
+  int par_den = 1;
+  int fps_scale = 0;
+  if (bs.readBits1())    /* vui_parameters_present flag */
+  {
+    if (bs.readBits1())  /* aspect_ratio_info_present */
+    {
+      uint32_t aspect_ratio_idc = bs.readBits(8);
+      demux_dbg(DEMUX_DBG_PARSE, "HEVC SPS: aspect_ratio_idc %d\n", aspect_ratio_idc);
+
+      if (aspect_ratio_idc == 255 /* Extended_SAR */)
+      {
+        par_num = bs.readBits(16); /* sar_width */
+        par_den = bs.readBits(16); /* sar_height */
+      }
+      else
+      {
+        static const int aspect_ratios[][2] =
+        { /* Table E-1 */
+          /* 0: unknown */
+          {0, 1},
+          /* 1...16: */
+          { 1,  1}, {12, 11}, {10, 11}, {16, 11}, { 40, 33}, {24, 11}, {20, 11}, {32, 11},
+          {80, 33}, {18, 11}, {15, 11}, {64, 33}, {160, 99}, { 4,  3}, { 3,  2}, { 2,  1}
+        };
+
+        if (aspect_ratio_idc < sizeof(aspect_ratios)/sizeof(aspect_ratios[0]))
+        {
+          par_num = aspect_ratios[aspect_ratio_idc][0];
+          par_den = aspect_ratios[aspect_ratio_idc][1];
+        }
+        else
+        {
+          demux_dbg(DEMUX_DBG_PARSE, "HEVC SPS: aspect_ratio_idc out of range !\n");
+        }
+      }
+    }
+    if (bs.readBits1()) // overscan_info_present_flag
+    {
+      bs.readBits1(); // overscan_appropriate_flag
+    }
+    if (bs.readBits1()) // video_signal_type_present_flag
+    {
+      bs.readBits(3); // video_format
+      bs.readBits1(); // video_full_range_flag
+      if (bs.readBits1()) // colour_description_present_flag
+      {
+        bs.readBits(8); // colour_primaries
+        bs.readBits(8); // transfer_characteristics
+        bs.readBits(8); // matrix_coeffs
+      }
+    }
+    if (bs.readBits1()) // chroma_loc_info_present_flag
+    {
+      bs.readGolombUE(); // chroma_sample_loc_type_top_field
+      bs.readGolombUE(); // chroma_sample_loc_type_bottom_field
+    }
+    bs.readBits1(); // neutral_chroma_indication_flag
+    if (bs.readBits1()) // field_seq_flag
+      interlaced = true;
+    bs.readBits1(); // frame_field_info_present_flag
+    if (bs.readBits1()) // default_display_window_flag
+    {
+      bs.readGolombUE(); // def_disp_win_left_offset
+      bs.readGolombUE(); // def_disp_win_right_offset
+      bs.readGolombUE(); // def_disp_win_top_offset
+      bs.readGolombUE(); // def_disp_win_bottom_offset
+    }
+    if (bs.readBits1()) // vui_timing_info_present_flag
+    {
+      uint32_t num_units_in_tick = bs.readBits(16) << 16;
+      num_units_in_tick |= bs.readBits(16);
+      uint32_t time_scale = bs.readBits(16) << 16;
+      time_scale |= bs.readBits(16);
+      if (num_units_in_tick > 0 && time_scale > 0 && !bs.isError())
+        fps_scale = static_cast<int>(Rescale(num_units_in_tick, RESCALE_TIME_BASE, time_scale));
+    }
+  }
+
+  if (bs.isError() || width <= 0 || height <= 0)
+    return false;
+
+  hevc_private::SPS &sps = m_streamData.sps[seq_parameter_set_id];
+  sps.valid = 1;
+  sps.width = width;
+  sps.height = height;
+  sps.interlaced = interlaced ? 1 : 0;
+  sps.par_num = par_num;
+  sps.par_den = par_den;
+  sps.fps_scale = fps_scale;
+
+  demux_dbg(DEMUX_DBG_PARSE, "HEVC SPS: -> video size %dx%d, aspect %d:%d\n", width, height, par_num, par_den);
+  return true;
+}
+
+void ES_hevc::Parse_PTL(cBitstream &bs, int max_sub_layers_minus1, bool &interlaced)
+{
+  bs.skipBits(8);                 /* general_profile_space, tier_flag, profile_idc */
+  bs.skipBits(32);                /* general_profile_compatibility_flags           */
+  int progressive_source = bs.readBits1();
+  int interlaced_source = bs.readBits1();
+  bs.skipBits(2);                 /* non_packed_constraint, frame_only_constraint  */
+  bs.skipBits(44);                /* reserved                                      */
+  bs.skipBits(8);                 /* general_level_idc                             */
+  interlaced = (interlaced_source && !progressive_source);
+
+  int sub_layer_profile_present[8];
+  int sub_layer_level_present[8];
+  for (int i = 0; i < max_sub_layers_minus1; i++)
+  {
+    sub_layer_profile_present[i] = bs.readBits1();
+    sub_layer_level_present[i] = bs.readBits1();
+  }
+  if (max_sub_layers_minus1 > 0)
+    bs.skipBits(2 * (8 - max_sub_layers_minus1)); /* reserved_zero_2bits */
+  for (int i = 0; i < max_sub_layers_minus1; i++)
+  {
+    if (sub_layer_profile_present[i])
+      bs.skipBits(88);
+    if (sub_layer_level_present[i])
+      bs.skipBits(8);
+  }
+}
+
+bool ES_hevc::Parse_ST_RPS(cBitstream &bs, int idx, int *num_delta_pocs)
+{
+  // In SPS, delta_idx_minus1 is never coded: the reference set is the previous one
+  if (idx != 0 && bs.readBits1()) /* inter_ref_pic_set_prediction_flag */
+  {
+    bs.skipBits(1);               /* delta_rps_sign       */
+    bs.readGolombUE();            /* abs_delta_rps_minus1 */
+    int count = 0;
+    for (int j = 0; j <= num_delta_pocs[idx - 1]; j++)
+    {
+      int use_delta = 1;
+      if (!bs.readBits1())        /* used_by_curr_pic_flag */
+        use_delta = bs.readBits1();
+      if (use_delta)
+        count++;
+    }
+    num_delta_pocs[idx] = count;
+  }
+  else
+  {
+    unsigned int num_negative_pics = bs.readGolombUE();
+    unsigned int num_positive_pics = bs.readGolombUE();
+    if (num_negative_pics > 16 || num_positive_pics > 16)
+      return false;
+    for (unsigned int i = 0; i < num_negative_pics + num_positive_pics; i++)
+    {
+      bs.readGolombUE();          /* delta_poc_minus1      */
+      bs.skipBits(1);             /* used_by_curr_pic_flag */
+    }
+    num_delta_pocs[idx] = num_negative_pics + num_positive_pics;
+  }
+  return !bs.isError();
+}
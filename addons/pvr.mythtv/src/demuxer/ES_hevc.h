@@ -0,0 +1,96 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef ES_HEVC_H
+#define ES_HEVC_H
+
+#include "elementaryStream.h"
+
+class cBitstream;
+
+class ES_hevc : public ElementaryStream
+{
+private:
+  typedef struct hevc_private
+  {
+    struct SPS
+    {
+      int valid;
+      int width;
+      int height;
+      int interlaced;
+      int par_num;
+      int par_den;
+      int fps_scale;
+    } sps[16];
+
+    struct PPS
+    {
+      int sps;
+    } pps[64];
+  } hevc_private_t;
+
+  enum
+  {
+    NAL_BLA_W_LP    = 16, // First IRAP type
+    NAL_RSV_IRAP_23 = 23, // Last IRAP type
+    NAL_VPS         = 32, // Video Parameter Set
+    NAL_SPS         = 33, // Sequence Parameter Set
+    NAL_PPS         = 34, // Picture Parameter Set
+    NAL_AUD         = 35, // Access Unit Delimiter
+    NAL_EOS         = 36, // End of Sequence
+    NAL_EOB         = 37, // End of Bitstream
+    NAL_FD          = 38, // Filler Data
+    NAL_SEI_PREFIX  = 39, // Supplemental Enhancement Information
+    NAL_SEI_SUFFIX  = 40  // Supplemental Enhancement Information
+  };
+
+  uint32_t        m_StartCode;
+  bool            m_NeedIFrame;
+  bool            m_NeedVPS;
+  bool            m_NeedSPS;
+  bool            m_NeedPPS;
+  int             m_Width;
+  int             m_Height;
+  int             m_FpsScale;
+  int             m_ParNum;
+  int             m_ParDen;
+  hevc_private    m_streamData;
+  int64_t         m_DTS;
+  int64_t         m_PTS;
+  bool            m_Interlaced;
+
+  int Parse_HEVC(uint32_t startcode, int buf_ptr, bool &complete);
+  bool Parse_PPS(uint8_t *buf, int len);
+  bool Parse_SLH(uint8_t *buf, int len, int nal_unit_type, bool &first_slice);
+  bool Parse_SPS(uint8_t *buf, int len);
+  void Parse_PTL(cBitstream &bs, int max_sub_layers_minus1, bool &interlaced);
+  bool Parse_ST_RPS(cBitstream &bs, int idx, int *num_delta_pocs);
+
+public:
+  ES_hevc(uint16_t pes_pid);
+  virtual ~ES_hevc();
+
+  virtual void Parse(STREAM_PKT* pkt);
+  virtual void Reset();
+};
+
+#endif /* ES_HEVC_H */
@@ -21,6 +21,60 @@
 
 #include "elementaryStream.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+/*
+ * Return the first start code prefix (00 00 01) lying entirely in [begin, end),
+ * or end if none is found.
+ */
+static const unsigned char* FindStartCodePrefix(const unsigned char* begin, const unsigned char* end)
+{
+  const unsigned char* p = begin;
+#if defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i one = _mm_set1_epi8(1);
+  // Test 16 candidate positions at once, then let the scalar loop locate the hit
+  while (end - p >= 18)
+  {
+    __m128i b0 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)p), zero);
+    __m128i b1 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(p + 1)), zero);
+    __m128i b2 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(p + 2)), one);
+    if (_mm_movemask_epi8(_mm_and_si128(_mm_and_si128(b0, b1), b2)))
+      break;
+    p += 16;
+  }
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+  const uint8x16_t zero = vdupq_n_u8(0);
+  const uint8x16_t one = vdupq_n_u8(1);
+  while (end - p >= 18)
+  {
+    uint8x16_t b0 = vceqq_u8(vld1q_u8(p), zero);
+    uint8x16_t b1 = vceqq_u8(vld1q_u8(p + 1), zero);
+    uint8x16_t b2 = vceqq_u8(vld1q_u8(p + 2), one);
+    uint64x2_t m = vreinterpretq_u64_u8(vandq_u8(vandq_u8(b0, b1), b2));
+    if (vgetq_lane_u64(m, 0) | vgetq_lane_u64(m, 1))
+      break;
+    p += 16;
+  }
+#endif
+  while (end - p >= 3)
+  {
+    if (p[2] > 1)
+      p += 3;
+    else if (p[1])
+      p += 2;
+    else if (p[0] || p[2] != 1)
+      p++;
+    else
+      return p;
+  }
+  return end;
+}
+
 ElementaryStream::ElementaryStream(uint16_t pes_pid)
   : pid(pes_pid)
   , stream_type(STREAM_TYPE_UNKNOWN)
@@ -68,9 +122,14 @@ int ElementaryStream::Append(const unsigned char* buf, size_t len, bool new_pts)
   if (new_pts)
     es_pts_pointer = es_len;
 
+  // Consumed payload stays in place while the tail has room for new data, so
+  // pending bytes are moved to the front once per buffer fill instead of on
+  // every append
   if (es_buf && es_consumed)
   {
-    if (es_consumed < es_len)
+    if (es_consumed >= es_len)
+      ClearBuffer();
+    else if (es_len + len > es_alloc)
     {
       memmove(es_buf, es_buf + es_consumed, es_len - es_consumed);
       es_len -= es_consumed;
@@ -82,8 +141,6 @@ int ElementaryStream::Append(const unsigned char* buf, size_t len, bool new_pts)
 
       es_consumed = 0;
     }
-    else
-      ClearBuffer();
   }
   if (es_len + len > es_alloc)
   {
@@ -139,6 +196,8 @@ const char* ElementaryStream::GetStreamCodecName(STREAM_TYPE stream_type)
       return "aac_latm";
     case STREAM_TYPE_VIDEO_H264:
       return "h264";
+    case STREAM_TYPE_VIDEO_HEVC:
+      return "hevc";
     case STREAM_TYPE_AUDIO_AC3:
       return "ac3";
     case STREAM_TYPE_AUDIO_EAC3:
@@ -180,10 +239,10 @@ void ElementaryStream::Parse(STREAM_PKT* pkt)
   // No parser: pass-through
   if (es_consumed < es_len)
   {
-    es_consumed = es_parsed = es_len;
     pkt->pid              = pid;
-    pkt->size             = es_consumed;
-    pkt->data             = es_buf;
+    pkt->size             = es_len - es_consumed;
+    pkt->data             = es_buf + es_consumed;
+    es_consumed = es_parsed = es_len;
     pkt->dts              = c_dts;
     pkt->pts              = c_pts;
     if (c_dts == PTS_UNSET || p_dts == PTS_UNSET)
@@ -285,3 +344,26 @@ bool ElementaryStream::SetAudioInformation(int Channels, int SampleRate, int Bit
   has_stream_info = true;
   return ret;
 }
+
+int ElementaryStream::NextStartCode(int buf_ptr, uint32_t& startcode) const
+{
+  // Same result as shifting startcode one byte at a time until it holds a
+  // start code prefix, or until less than 4 bytes remain in the buffer
+  int end = static_cast<int>(es_len) - 3;
+
+  // The first bytes complete a prefix possibly begun in the previous call
+  for (int i = 0; i < 3; i++)
+  {
+    startcode = startcode << 8 | es_buf[buf_ptr++];
+    if (buf_ptr >= end || (startcode & 0xffffff00) == 0x00000100)
+      return buf_ptr;
+  }
+
+  const unsigned char* limit = es_buf + es_len - 4;
+  const unsigned char* found = FindStartCodePrefix(es_buf + buf_ptr - 3, limit);
+  buf_ptr = (found != limit ? static_cast<int>(found - es_buf) + 4 : end);
+
+  const unsigned char* sc = es_buf + buf_ptr - 4;
+  startcode = (uint32_t)sc[0] << 24 | (uint32_t)sc[1] << 16 | (uint32_t)sc[2] << 8 | sc[3];
+  return buf_ptr;
+}
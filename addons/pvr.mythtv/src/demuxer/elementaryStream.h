@@ -35,6 +35,7 @@ enum STREAM_TYPE
   STREAM_TYPE_AUDIO_AAC_ADTS,
   STREAM_TYPE_AUDIO_AAC_LATM,
   STREAM_TYPE_VIDEO_H264,
+  STREAM_TYPE_VIDEO_HEVC,
   STREAM_TYPE_AUDIO_AC3,
   STREAM_TYPE_AUDIO_EAC3,
   STREAM_TYPE_DVB_TELETEXT,
@@ -103,12 +104,13 @@ protected:
   uint64_t Rescale(uint64_t a, uint64_t b, uint64_t c);
   bool SetVideoInformation(int FpsScale, int FpsRate, int Height, int Width, float Aspect, bool Interlaced);
   bool SetAudioInformation(int Channels, int SampleRate, int BitRate, int BitsPerSample, int BlockAlign);
+  int NextStartCode(int buf_ptr, uint32_t& startcode) const;
 
   size_t es_alloc_init;         ///< Initial allocation of memory for buffer
   unsigned char* es_buf;        ///< The Pointer to buffer
   size_t es_alloc;              ///< Allocated size of memory for buffer
   size_t es_len;                ///< Size of data in buffer
-  size_t es_consumed;           ///< Consumed payload. Will be erased on next append
+  size_t es_consumed;           ///< Consumed payload. Will be erased when the buffer is full
   size_t es_pts_pointer;        ///< Position in buffer where current PTS becomes applicable
   size_t es_parsed;             ///< Parser: Last processed position in buffer
   bool   es_found_frame;        ///< Parser: Found frame
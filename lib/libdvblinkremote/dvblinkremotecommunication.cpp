@@ -298,7 +298,7 @@ DVBLinkRemoteStatusCode DVBLinkRemoteCommunication::GetData(const std::string& c
       WriteError("HTTP response returned status code %d.\n", httpResponse->GetStatusCode());
     }
     else {
-      std::string responseData = httpResponse->GetResponseData();
+      std::string& responseData = httpResponse->GetResponseData();
       
       if ((status = DeserializeResponseData(command, responseData, responseObject)) != DVBLINK_REMOTE_STATUS_OK) {
         WriteError("Deserialization of response data failed with error code %d (%s).\n", status, GetStatusCodeDescription(status).c_str());
@@ -337,7 +337,12 @@ DVBLinkRemoteStatusCode DVBLinkRemoteCommunication::DeserializeResponseData(cons
     GenericResponseSerializer* genericResponseSerializer = new GenericResponseSerializer();
     GenericResponse* genericResponse = new GenericResponse();
     
-    if (genericResponseSerializer->ReadObject(*genericResponse, responseData)) {
+    bool read = genericResponseSerializer->ReadObject(*genericResponse, responseData);
+
+    // the parsed envelope holds a copy of the result, release it before the result is parsed
+    delete genericResponseSerializer;
+
+    if (read) {
       if ((status = (DVBLinkRemoteStatusCode)genericResponse->GetStatusCode()) == DVBLINK_REMOTE_STATUS_OK) {
         if (!XmlObjectSerializerFactory::Deserialize(command, genericResponse->GetXmlResult(), responseObject)) {
           status = DVBLINK_REMOTE_STATUS_INVALID_DATA;
@@ -346,7 +351,6 @@ DVBLinkRemoteStatusCode DVBLinkRemoteCommunication::DeserializeResponseData(cons
     }
 
     delete genericResponse;
-    delete genericResponseSerializer;
   }
 
   return status;
@@ -61,7 +61,7 @@ std::string& GenericResponse::GetXmlResult()
 
 void GenericResponse::SetXmlResult(const std::string& xmlResult) 
 { 
-  m_xmlResult = std::string(xmlResult); 
+  m_xmlResult = xmlResult; 
 }
 
 GenericResponseSerializer::GenericResponseSerializer()
@@ -74,7 +74,7 @@ bool GenericResponseSerializer::ReadObject(GenericResponse& object, const std::s
 {
   tinyxml2::XMLDocument& doc = GetXmlDocument();
     
-  if (doc.Parse(xml.c_str()) == tinyxml2::XML_NO_ERROR) {
+  if (doc.Parse(xml.c_str(), xml.size()) == tinyxml2::XML_NO_ERROR) {
     tinyxml2::XMLElement* elRoot = doc.FirstChildElement("response");
     int statusCode = Util::GetXmlFirstChildElementTextAsInt(elRoot, "status_code");
 
@@ -82,10 +82,11 @@ bool GenericResponseSerializer::ReadObject(GenericResponse& object, const std::s
       object.SetStatusCode(DVBLINK_REMOTE_STATUS_INVALID_DATA);
     }
 
-    std::string xml_result = std::string(Util::GetXmlFirstChildElementText(elRoot, "xml_result"));
+    // the result may be megabytes of guide data, copy it once
+    const char* xml_result = Util::GetXmlFirstChildElementText(elRoot, "xml_result");
 
-    if (!xml_result.empty()) {
-      object.SetXmlResult(xml_result);
+    if (*xml_result != '\0') {
+      object.GetXmlResult().assign(xml_result);
     }
 
     return true;
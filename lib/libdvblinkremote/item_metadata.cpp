@@ -21,6 +21,8 @@
  *
  ***************************************************************************/
 
+#include <stdlib.h>
+#include <string.h>
 #include "response.h"
 #include "xml_object_serializer.h"
 
@@ -203,53 +205,139 @@ void ItemMetadata::SetDuration(const long duration)
   m_duration = duration; 
 }
 
+namespace
+{
+  struct TextField { const char* name; std::string ItemMetadata::* member; };
+  struct NumberField { const char* name; long ItemMetadata::* member; };
+  struct FlagField { const char* name; bool ItemMetadata::* member; };
+
+  const TextField textFields[] = {
+    { "short_desc", &ItemMetadata::ShortDescription },
+    { "subname", &ItemMetadata::SubTitle },
+    { "language", &ItemMetadata::Language },
+    { "actors", &ItemMetadata::Actors },
+    { "directors", &ItemMetadata::Directors },
+    { "writers", &ItemMetadata::Writers },
+    { "producers", &ItemMetadata::Producers },
+    { "guests", &ItemMetadata::Guests },
+    { "categories", &ItemMetadata::Keywords },
+    { "image", &ItemMetadata::Image }
+  };
+
+  const NumberField numberFields[] = {
+    { "year", &ItemMetadata::Year },
+    { "episode_num", &ItemMetadata::EpisodeNumber },
+    { "season_num", &ItemMetadata::SeasonNumber },
+    { "stars_num", &ItemMetadata::Rating },
+    { "starsmax_num", &ItemMetadata::MaximumRating }
+  };
+
+  const FlagField flagFields[] = {
+    { "hdtv", &ItemMetadata::IsHdtv },
+    { "premiere", &ItemMetadata::IsPremiere },
+    { "repeat", &ItemMetadata::IsRepeat },
+    { "is_series", &ItemMetadata::IsSeries },
+    { "is_record", &ItemMetadata::IsRecord },
+    { "is_repeat_record", &ItemMetadata::IsRepeatRecord },
+    { "cat_action", &ItemMetadata::IsCatAction },
+    { "cat_comedy", &ItemMetadata::IsCatComedy },
+    { "cat_documentary", &ItemMetadata::IsCatDocumentary },
+    { "cat_drama", &ItemMetadata::IsCatDrama },
+    { "cat_educational", &ItemMetadata::IsCatEducational },
+    { "cat_horror", &ItemMetadata::IsCatHorror },
+    { "cat_kids", &ItemMetadata::IsCatKids },
+    { "cat_movie", &ItemMetadata::IsCatMovie },
+    { "cat_music", &ItemMetadata::IsCatMusic },
+    { "cat_news", &ItemMetadata::IsCatNews },
+    { "cat_reality", &ItemMetadata::IsCatReality },
+    { "cat_romance", &ItemMetadata::IsCatRomance },
+    { "cat_scifi", &ItemMetadata::IsCatScifi },
+    { "cat_serial", &ItemMetadata::IsCatSerial },
+    { "cat_soap", &ItemMetadata::IsCatSoap },
+    { "cat_special", &ItemMetadata::IsCatSpecial },
+    { "cat_sports", &ItemMetadata::IsCatSports },
+    { "cat_thriller", &ItemMetadata::IsCatThriller },
+    { "cat_adult", &ItemMetadata::IsCatAdult }
+  };
+
+  const size_t textFieldCount = sizeof(textFields) / sizeof(textFields[0]);
+  const size_t numberFieldCount = sizeof(numberFields) / sizeof(numberFields[0]);
+  const size_t flagFieldCount = sizeof(flagFields) / sizeof(flagFields[0]);
+
+  // same result as Util::GetXmlFirstChildElementTextAsLong without a string stream per value
+  long ParseLong(const char* text)
+  {
+    if (text == NULL) {
+      return -1;
+    }
+
+    char* end;
+    long value = strtol(text, &end, 10);
+
+    return end == text ? -1 : value;
+  }
+
+  void SetField(ItemMetadata& itemMetadata, const char* name, const char* text)
+  {
+    for (size_t i = 0; i < textFieldCount; i++) {
+      if (strcmp(name, textFields[i].name) == 0) {
+        (itemMetadata.*textFields[i].member).assign(text ? text : "");
+        return;
+      }
+    }
+
+    for (size_t i = 0; i < numberFieldCount; i++) {
+      if (strcmp(name, numberFields[i].name) == 0) {
+        itemMetadata.*numberFields[i].member = ParseLong(text);
+        return;
+      }
+    }
+
+    for (size_t i = 0; i < flagFieldCount; i++) {
+      if (strcmp(name, flagFields[i].name) == 0) {
+        itemMetadata.*flagFields[i].member = true;
+        return;
+      }
+    }
+  }
+}
+
 void ItemMetadataSerializer::Deserialize(XmlObjectSerializer<Response>& objectSerializer, const tinyxml2::XMLElement& element, dvblinkremote::ItemMetadata& itemMetadata)
 {
-  itemMetadata.SetTitle(Util::GetXmlFirstChildElementText(&element, "name"));
-  itemMetadata.SetStartTime(Util::GetXmlFirstChildElementTextAsLong(&element, "start_time"));
-  itemMetadata.SetDuration(Util::GetXmlFirstChildElementTextAsLong(&element, "duration"));
-
-  itemMetadata.ShortDescription = Util::GetXmlFirstChildElementText(&element, "short_desc");
-  itemMetadata.SubTitle = Util::GetXmlFirstChildElementText(&element, "subname");
-  itemMetadata.Language = Util::GetXmlFirstChildElementText(&element, "language");
-  itemMetadata.Actors = Util::GetXmlFirstChildElementText(&element, "actors");
-  itemMetadata.Directors = Util::GetXmlFirstChildElementText(&element, "directors");
-  itemMetadata.Writers = Util::GetXmlFirstChildElementText(&element, "writers");
-  itemMetadata.Producers = Util::GetXmlFirstChildElementText(&element, "producers");
-  itemMetadata.Guests = Util::GetXmlFirstChildElementText(&element, "guests");
-  itemMetadata.Keywords = Util::GetXmlFirstChildElementText(&element, "categories");
-  itemMetadata.Image = Util::GetXmlFirstChildElementText(&element, "image");
-         
-  itemMetadata.Year = Util::GetXmlFirstChildElementTextAsLong(&element, "year");
-  itemMetadata.EpisodeNumber = Util::GetXmlFirstChildElementTextAsLong(&element, "episode_num");
-  itemMetadata.SeasonNumber = Util::GetXmlFirstChildElementTextAsLong(&element, "season_num");
-  itemMetadata.Rating = Util::GetXmlFirstChildElementTextAsLong(&element, "stars_num");
-  itemMetadata.MaximumRating = Util::GetXmlFirstChildElementTextAsLong(&element, "starsmax_num");
-         
-  itemMetadata.IsHdtv = objectSerializer.HasChildElement(*&element, "hdtv");
-  itemMetadata.IsPremiere = objectSerializer.HasChildElement(*&element, "premiere");
-  itemMetadata.IsRepeat = objectSerializer.HasChildElement(*&element, "repeat");
-  itemMetadata.IsSeries = objectSerializer.HasChildElement(*&element, "is_series");
-  itemMetadata.IsRecord = objectSerializer.HasChildElement(*&element, "is_record");
-  itemMetadata.IsRepeatRecord = objectSerializer.HasChildElement(*&element, "is_repeat_record");
-         
-  itemMetadata.IsCatAction = objectSerializer.HasChildElement(*&element, "cat_action");
-  itemMetadata.IsCatComedy = objectSerializer.HasChildElement(*&element, "cat_comedy");
-  itemMetadata.IsCatDocumentary = objectSerializer.HasChildElement(*&element, "cat_documentary");
-  itemMetadata.IsCatDrama = objectSerializer.HasChildElement(*&element, "cat_drama");
-  itemMetadata.IsCatEducational = objectSerializer.HasChildElement(*&element, "cat_educational");
-  itemMetadata.IsCatHorror = objectSerializer.HasChildElement(*&element, "cat_horror");
-  itemMetadata.IsCatKids = objectSerializer.HasChildElement(*&element, "cat_kids");
-  itemMetadata.IsCatMovie = objectSerializer.HasChildElement(*&element, "cat_movie");
-  itemMetadata.IsCatMusic = objectSerializer.HasChildElement(*&element, "cat_music");
-  itemMetadata.IsCatNews = objectSerializer.HasChildElement(*&element, "cat_news");
-  itemMetadata.IsCatReality = objectSerializer.HasChildElement(*&element, "cat_reality");
-  itemMetadata.IsCatRomance = objectSerializer.HasChildElement(*&element, "cat_romance");
-  itemMetadata.IsCatScifi = objectSerializer.HasChildElement(*&element, "cat_scifi");
-  itemMetadata.IsCatSerial = objectSerializer.HasChildElement(*&element, "cat_serial");
-  itemMetadata.IsCatSoap = objectSerializer.HasChildElement(*&element, "cat_soap");
-  itemMetadata.IsCatSpecial = objectSerializer.HasChildElement(*&element, "cat_special");
-  itemMetadata.IsCatSports = objectSerializer.HasChildElement(*&element, "cat_sports");
-  itemMetadata.IsCatThriller = objectSerializer.HasChildElement(*&element, "cat_thriller");
-  itemMetadata.IsCatAdult = objectSerializer.HasChildElement(*&element, "cat_adult");
+  // missing elements read as empty text, -1 and false
+  itemMetadata.SetTitle("");
+  itemMetadata.SetStartTime(-1);
+  itemMetadata.SetDuration(-1);
+
+  for (size_t i = 0; i < textFieldCount; i++) {
+    (itemMetadata.*textFields[i].member).clear();
+  }
+
+  for (size_t i = 0; i < numberFieldCount; i++) {
+    itemMetadata.*numberFields[i].member = -1;
+  }
+
+  for (size_t i = 0; i < flagFieldCount; i++) {
+    itemMetadata.*flagFields[i].member = false;
+  }
+
+  // one pass over the children instead of a lookup per field, a guide response holds
+  // thousands of programs. Walk backwards so that the first of repeated elements wins.
+  for (const tinyxml2::XMLElement* child = element.LastChildElement(); child != NULL; child = child->PreviousSiblingElement()) {
+    const char* name = child->Name();
+    const char* text = child->GetText();
+
+    if (strcmp(name, "name") == 0) {
+      itemMetadata.SetTitle(text ? text : "");
+    }
+    else if (strcmp(name, "start_time") == 0) {
+      itemMetadata.SetStartTime(ParseLong(text));
+    }
+    else if (strcmp(name, "duration") == 0) {
+      itemMetadata.SetDuration(ParseLong(text));
+    }
+    else {
+      SetField(itemMetadata, name, text);
+    }
+  }
 }
@@ -33,13 +33,11 @@
  */
 
 #include "FileReader.h"
-#include "client.h" //for XBMC->Log
 #include "TSDebug.h"
 #include "platform/threads/threads.h"
 #include <algorithm> //std::min, std::max
 #include "platform/util/timeutils.h" // for usleep
 #include "platform/util/util.h"
-#include "utils.h"
 #include <errno.h>
 
 using namespace ADDON;
@@ -80,7 +78,7 @@ long FileReader::GetFileName(std::string& fileName)
 
 long FileReader::SetFileName(const std::string& fileName)
 {
-  m_fileName = ToXBMCPath(fileName);
+  m_fileName = fileName;
   return S_OK;
 }
 
@@ -219,6 +217,16 @@ int64_t FileReader::GetFileSize()
   return XBMC->GetFileLength(m_hFile);
 }
 
+bool FileReader::WaitForData(unsigned long dwTimeoutMs)
+{
+  // A plain file gives no hint when it grows, so just give the writer some time
+  if (dwTimeoutMs == 0)
+    return false;
+
+  usleep(std::min(dwTimeoutMs, (unsigned long) WAIT_FOR_DATA_INTERVAL) * 1000);
+  return true;
+}
+
 int64_t FileReader::OnChannelChange(void)
 {
   return XBMC->GetFilePosition(m_hFile);
@@ -36,6 +36,9 @@
 #include "platform/os.h"
 #include "platform/util/StdString.h"
 
+//Time in msec between two checks for new data while waiting at the end of a file
+#define WAIT_FOR_DATA_INTERVAL 20
+
 class FileReader
 {
   public:
@@ -56,6 +59,8 @@ class FileReader
     virtual bool IsBuffer() { return false; };
     virtual int64_t OnChannelChange(void);
     virtual int HasData(){return 0; } ;
+    // Wait until data is available beyond the read position, true when there may be data to read
+    virtual bool WaitForData(unsigned long dwTimeoutMs);
 
   protected:
     void*      m_hFile;               // Handle to file for streaming
@@ -33,14 +33,13 @@
  */
 
 #include "MultiFileReader.h"
-#include "client.h" //for XBMC->Log
 #include "TSDebug.h"
 #include <string>
-#include "utils.h"
 #include <algorithm>
 #include "platform/util/timeutils.h"
 #include "platform/util/StdString.h"
 #include "platform/threads/threads.h"
+#include "platform/util/util.h"
 #include <inttypes.h>
 
 using namespace ADDON;
@@ -49,6 +48,14 @@ using namespace PLATFORM;
 //Maximum time in msec to wait for the buffer file to become available - Needed for DVB radio (this sometimes takes some time)
 #define MAX_BUFFER_TIMEOUT 1500
 
+//Maximum time in msec that reads within the known buffer go without re-reading the buffer file
+#define BUFFER_REFRESH_INTERVAL 1000
+
+//Size of the blocks read from the buffer files, and the alignment of their start within a file.
+//Network file systems do much better with few large reads than with many player sized ones.
+#define READ_AHEAD_SIZE      262144
+#define READ_AHEAD_ALIGNMENT 65536
+
 MultiFileReader::MultiFileReader():
   m_TSBufferFile(),
   m_TSFile()
@@ -59,8 +66,11 @@ MultiFileReader::MultiFileReader():
   m_lastZapPosition = 0;
   m_filesAdded = 0;
   m_filesRemoved = 0;
+  m_lastRefreshTime = 0;
   m_TSFileId = 0;
   m_bDelay = 0;
+  m_readAheadStart = 0;
+  m_readAheadLength = 0;
 }
 
 MultiFileReader::~MultiFileReader()
@@ -144,6 +154,8 @@ long MultiFileReader::CloseFile()
     delete (*it);
   }
   m_tsFiles.clear();
+  m_readAheadBuffer.clear();
+  m_readAheadLength = 0;
 
   m_TSFileId = 0;
   return hr;
@@ -245,7 +257,13 @@ long MultiFileReader::Read(unsigned char* pbData, unsigned long lDataLength, uns
   if (m_TSBufferFile.IsFileInvalid())
     return S_FALSE;
 
-  RefreshTSBufferFile();
+  // The buffer file only needs to be read again for data beyond the known end. Do it once
+  // in a while anyway, files are dropped from the start while the buffer is being written.
+  if ((m_currentPosition + (int64_t) lDataLength > m_endPosition) ||
+      (PLATFORM::GetTimeMs() - m_lastRefreshTime >= BUFFER_REFRESH_INTERVAL))
+  {
+    RefreshTSBufferFile();
+  }
 
   if (m_currentPosition < m_startPosition)
   {
@@ -253,96 +271,128 @@ long MultiFileReader::Read(unsigned char* pbData, unsigned long lDataLength, uns
     m_currentPosition = m_startPosition;
   }
 
-  // Find out which file the currentPosition is in.
-  MultiFileReaderFile *file = NULL;
-  std::vector<MultiFileReaderFile *>::iterator it = m_tsFiles.begin();
-  for ( ; it < m_tsFiles.end(); ++it )
-  {
-    file = *it;
-    if (m_currentPosition < (file->startPosition + file->length))
-      break;
-  };
-
-  // XBMC->Log(LOG_DEBUG, "%s: reading %ld bytes. File %s, start %d, current %d, end %d.", __FUNCTION__, lDataLength, file->filename.c_str(), m_startPosition, m_currentPosition, m_endPosition);
-
-  if(!file)
+  if (m_tsFiles.empty())
   {
     XBMC->Log(LOG_ERROR, "MultiFileReader::no file");
     XBMC->QueueNotification(QUEUE_ERROR, "No buffer file");
     return S_FALSE;
   }
-  if (m_currentPosition < (file->startPosition + file->length))
+
+  // XBMC->Log(LOG_DEBUG, "%s: reading %ld bytes. start %lli, current %lli, end %lli.", __FUNCTION__, lDataLength, m_startPosition, m_currentPosition, m_endPosition);
+
+  *dwReadBytes = 0;
+
+  while (lDataLength > 0)
   {
-    if (m_TSFileId != file->filePositionId)
+    // Serve the read from the block in memory when it holds the current position
+    if (m_readAheadLength == 0 || m_currentPosition < m_readAheadStart ||
+        m_currentPosition >= m_readAheadStart + (int64_t) m_readAheadLength)
     {
-      m_TSFile.CloseFile();
-      m_TSFile.SetFileName(file->filename.c_str());
-      if (m_TSFile.OpenFile() != S_OK)
-      {
-        XBMC->Log(LOG_ERROR, "MultiFileReader: can't open %s\n", file->filename.c_str());
-        return S_FALSE;
-      }
+      // Find out which file the currentPosition is in, past the end of the last file there is nothing to read yet
+      MultiFileReaderFile *file = FindFile(m_currentPosition);
+      if (!file)
+        break;
 
-      m_TSFileId = file->filePositionId;
-      m_currentFileStartOffset = file->startPosition;
+      if (FillReadAhead(file) != S_OK)
+        return S_FALSE;
 
-      TSDEBUG(LOG_DEBUG, "MultiFileReader::Read() Current File Changed to %s TS file id=%i\n", file->filename.c_str(), m_TSFileId);
+      if (m_readAheadLength == 0)
+        break;
     }
 
-    int64_t seekPosition = m_currentPosition - file->startPosition;
+    unsigned long offset = (unsigned long) (m_currentPosition - m_readAheadStart);
+    unsigned long bytesToCopy = std::min(lDataLength, m_readAheadLength - offset);
 
-    m_TSFile.SetFilePointer(seekPosition, FILE_BEGIN);
-    int64_t posSeeked = m_TSFile.GetFilePointer();
-    if (posSeeked != seekPosition)
+    memcpy(pbData, &m_readAheadBuffer[offset], bytesToCopy);
+    pbData += bytesToCopy;
+    lDataLength -= bytesToCopy;
+    *dwReadBytes += bytesToCopy;
+    m_currentPosition += bytesToCopy;
+  }
+
+  // XBMC->Log(LOG_DEBUG, "%s: read %lu bytes. start %lli, current %lli, end %lli.", __FUNCTION__, *dwReadBytes, m_startPosition, m_currentPosition, m_endPosition);
+  return S_OK;
+}
+
+static bool CompareFileStart(int64_t position, const MultiFileReaderFile* file)
+{
+  return position < file->startPosition;
+}
+
+MultiFileReaderFile* MultiFileReader::FindFile(int64_t position)
+{
+  // The files are ordered by start position, take the last one starting at or before the position
+  std::vector<MultiFileReaderFile *>::iterator it = std::upper_bound(m_tsFiles.begin(), m_tsFiles.end(), position, CompareFileStart);
+  if (it == m_tsFiles.begin())
+    return NULL;
+
+  MultiFileReaderFile* file = *(--it);
+  if (position >= file->startPosition + file->length)
+    return NULL;
+
+  return file;
+}
+
+long MultiFileReader::FillReadAhead(MultiFileReaderFile* file)
+{
+  m_readAheadLength = 0;
+
+  if (m_TSFileId != file->filePositionId)
+  {
+    m_TSFile.CloseFile();
+    m_TSFile.SetFileName(file->filename.c_str());
+    if (m_TSFile.OpenFile() != S_OK)
     {
-      m_TSFile.SetFilePointer(seekPosition, FILE_BEGIN);
-      posSeeked = m_TSFile.GetFilePointer();
-      if (posSeeked != seekPosition)
-      {
-        XBMC->Log(LOG_ERROR, "SEEK FAILED");
-        return S_FALSE;
-      }
+      XBMC->Log(LOG_ERROR, "MultiFileReader: can't open %s\n", file->filename.c_str());
+      return S_FALSE;
     }
 
-    unsigned long bytesRead = 0;
-    long hr;
+    m_TSFileId = file->filePositionId;
+    m_currentFileStartOffset = file->startPosition;
 
-    int64_t bytesToRead = file->length - seekPosition;
-    if ((int64_t)lDataLength > bytesToRead)
-    {
-      // XBMC->Log(LOG_DEBUG, "%s: datalength %lu bytesToRead %lli.", __FUNCTION__, lDataLength, bytesToRead);
-      hr = m_TSFile.Read(pbData, (unsigned long)bytesToRead, &bytesRead);
-      if (FAILED(hr))
-      {
-        XBMC->Log(LOG_ERROR, "READ FAILED1");
-        return S_FALSE;
-      }
-      m_currentPosition += bytesToRead;
+    TSDEBUG(LOG_DEBUG, "MultiFileReader::Read() Current File Changed to %s TS file id=%i\n", file->filename.c_str(), m_TSFileId);
+  }
 
-      hr = this->Read(pbData + bytesToRead, lDataLength - (unsigned long)bytesToRead, dwReadBytes);
-      if (FAILED(hr))
-      {
-        XBMC->Log(LOG_ERROR, "READ FAILED2");
-      }
-      *dwReadBytes += bytesRead;
-    }
-    else
+  // Read an aligned block holding the current position, but not past the data written so far
+  int64_t seekPosition = m_currentPosition - file->startPosition;
+  seekPosition -= seekPosition % READ_AHEAD_ALIGNMENT;
+
+  int64_t bytesToRead = std::min((int64_t) READ_AHEAD_SIZE, file->length - seekPosition);
+  bytesToRead = std::min(bytesToRead, m_endPosition - (file->startPosition + seekPosition));
+  if (bytesToRead <= 0)
+    return S_OK;
+
+  m_TSFile.SetFilePointer(seekPosition, FILE_BEGIN);
+  int64_t posSeeked = m_TSFile.GetFilePointer();
+  if (posSeeked != seekPosition)
+  {
+    m_TSFile.SetFilePointer(seekPosition, FILE_BEGIN);
+    posSeeked = m_TSFile.GetFilePointer();
+    if (posSeeked != seekPosition)
     {
-      hr = m_TSFile.Read(pbData, lDataLength, dwReadBytes);
-      if (FAILED(hr))
-      {
-        XBMC->Log(LOG_ERROR, "READ FAILED3");
-      }
-      m_currentPosition += lDataLength;
+      XBMC->Log(LOG_ERROR, "SEEK FAILED");
+      return S_FALSE;
     }
   }
-  else
+
+  if (m_readAheadBuffer.size() < READ_AHEAD_SIZE)
+    m_readAheadBuffer.resize(READ_AHEAD_SIZE);
+
+  unsigned long bytesRead = 0;
+  long hr = m_TSFile.Read(&m_readAheadBuffer[0], (unsigned long) bytesToRead, &bytesRead);
+  if (FAILED(hr))
   {
-    // The current position is past the end of the last file
-    *dwReadBytes = 0;
+    XBMC->Log(LOG_ERROR, "READ FAILED");
+    return S_FALSE;
   }
 
-  // XBMC->Log(LOG_DEBUG, "%s: read %lu bytes. start %lli, current %lli, end %lli.", __FUNCTION__, *dwReadBytes, m_startPosition, m_currentPosition, m_endPosition);
+  m_readAheadStart = file->startPosition + seekPosition;
+  m_readAheadLength = bytesRead;
+
+  // A short read may end before the current position
+  if (m_readAheadStart + (int64_t) m_readAheadLength <= m_currentPosition)
+    m_readAheadLength = 0;
+
   return S_OK;
 }
 
@@ -475,6 +525,10 @@ long MultiFileReader::RefreshTSBufferFile()
 
     TSDEBUG(LOG_DEBUG, "MultiFileReader: Files Added %i, Removed %i\n", filesToAdd, filesToRemove);
 
+    // The files of the buffer are reused, so a block read earlier may be overwritten now
+    if (filesToRemove > 0)
+      m_readAheadLength = 0;
+
     // Removed files that aren't present anymore.
     while ((filesToRemove > 0) && (!m_tsFiles.empty()))
     {
@@ -624,6 +678,8 @@ long MultiFileReader::RefreshTSBufferFile()
     m_endPosition = 0;
   }
 
+  m_lastRefreshTime = PLATFORM::GetTimeMs();
+
   return S_OK;
 }
 
@@ -655,6 +711,27 @@ int64_t MultiFileReader::GetFileSize()
   return m_endPosition - m_startPosition;
 }
 
+bool MultiFileReader::WaitForData(unsigned long dwTimeoutMs)
+{
+  PLATFORM::CTimeout timeout(dwTimeoutMs);
+
+  // The buffer file header holds the write position, check it until it is past our read position
+  while (!m_TSBufferFile.IsFileInvalid())
+  {
+    RefreshTSBufferFile();
+
+    if (m_currentPosition < m_endPosition)
+      return true;
+
+    if (timeout.TimeLeft() == 0)
+      break;
+
+    usleep(std::min(timeout.TimeLeft(), (uint32_t) WAIT_FOR_DATA_INTERVAL) * 1000);
+  }
+
+  return false;
+}
+
 int64_t MultiFileReader::OnChannelChange(void)
 {
   m_lastZapPosition = m_currentPosition;
@@ -64,11 +64,14 @@ class MultiFileReader : public FileReader
     virtual int64_t GetFilePointer();
     virtual int64_t GetFileSize();
     virtual int64_t OnChannelChange(void);
+    virtual bool WaitForData(unsigned long dwTimeoutMs);
     int64_t SetCurrentFilePointer(int64_t timeShiftBufferFilePos, long timeshiftBufferFileID);
 
   protected:
     long RefreshTSBufferFile();
     long GetFileLength(const char* pFilename, int64_t &length);
+    MultiFileReaderFile* FindFile(int64_t position);
+    long FillReadAhead(MultiFileReaderFile* file);
 
     FileReader m_TSBufferFile;
     int64_t m_startPosition;
@@ -78,10 +81,16 @@ class MultiFileReader : public FileReader
     int64_t m_lastZapPosition;
     int32_t m_filesAdded;
     int32_t m_filesRemoved;
+    int64_t m_lastRefreshTime;
 
     std::vector<MultiFileReaderFile *> m_tsFiles;
 
     FileReader m_TSFile;
     long     m_TSFileId;
     bool     m_bDelay;
+
+    // Block read from the buffer files ahead of the read position
+    std::vector<unsigned char> m_readAheadBuffer;
+    int64_t  m_readAheadStart;
+    unsigned long m_readAheadLength;
 };
@@ -0,0 +1,205 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TSBufferTestSet.h"
+#include "TSDebug.h"
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+ADDON::CHelper_libXBMC_addon *XBMC = NULL;
+
+namespace
+{
+  void TestLog(void *HANDLE, void* CB, const ADDON::addon_log_t loglevel, const char *msg)
+  {
+    if (loglevel == ADDON::LOG_ERROR)
+      fprintf(stderr, "tsreader: %s\n", msg);
+  }
+
+  void TestQueueNotification(void *HANDLE, void* CB, const ADDON::queue_msg_t type, const char *msg)
+  {
+  }
+
+  void* TestOpenFile(void *HANDLE, void* CB, const char* strFileName, unsigned int flags)
+  {
+    return fopen(strFileName, "rb");
+  }
+
+  unsigned int TestReadFile(void *HANDLE, void* CB, void* file, void* lpBuf, int64_t uiBufSize)
+  {
+    return (unsigned int) fread(lpBuf, 1, (size_t) uiBufSize, (FILE*) file);
+  }
+
+  int64_t TestSeekFile(void *HANDLE, void* CB, void* file, int64_t iFilePosition, int iWhence)
+  {
+    if (fseeko((FILE*) file, (off_t) iFilePosition, iWhence) != 0)
+      return -1;
+    return ftello((FILE*) file);
+  }
+
+  int64_t TestGetFilePosition(void *HANDLE, void* CB, void* file)
+  {
+    return ftello((FILE*) file);
+  }
+
+  int64_t TestGetFileLength(void *HANDLE, void* CB, void* file)
+  {
+    off_t position = ftello((FILE*) file);
+    fseeko((FILE*) file, 0, SEEK_END);
+    off_t length = ftello((FILE*) file);
+    fseeko((FILE*) file, position, SEEK_SET);
+    return length;
+  }
+
+  void TestCloseFile(void *HANDLE, void* CB, void* file)
+  {
+    fclose((FILE*) file);
+  }
+
+  int TestStatFile(void *HANDLE, void* CB, const char *strFileName, struct __stat64* buffer)
+  {
+    return -1;
+  }
+
+  // The callbacks are normally resolved from the XBMC library by RegisterMe()
+  class CTestHelper : public ADDON::CHelper_libXBMC_addon
+  {
+  public:
+    CTestHelper()
+    {
+      XBMC_log                = TestLog;
+      XBMC_queue_notification = TestQueueNotification;
+      XBMC_open_file          = TestOpenFile;
+      XBMC_read_file          = TestReadFile;
+      XBMC_seek_file          = TestSeekFile;
+      XBMC_get_file_position  = TestGetFilePosition;
+      XBMC_get_file_length    = TestGetFileLength;
+      XBMC_close_file         = TestCloseFile;
+      XBMC_stat_file          = TestStatFile;
+    }
+  };
+}
+
+void InitTestXBMC(void)
+{
+  if (!XBMC)
+    XBMC = new CTestHelper();
+}
+
+void ReleaseTestXBMC(void)
+{
+  delete XBMC;
+  XBMC = NULL;
+}
+
+CTSBufferTestSet::CTSBufferTestSet()
+{
+}
+
+CTSBufferTestSet::~CTSBufferTestSet()
+{
+  for (std::vector<std::string>::iterator it = m_files.begin(); it != m_files.end(); ++it)
+    unlink(it->c_str());
+  if (!m_directory.empty())
+    rmdir(m_directory.c_str());
+}
+
+bool CTSBufferTestSet::Create(void)
+{
+  const char* tmp = getenv("TMPDIR");
+  std::string pattern = std::string(tmp && *tmp ? tmp : "/tmp") + "/tsreader.XXXXXX";
+
+  std::vector<char> path(pattern.begin(), pattern.end());
+  path.push_back('\0');
+  if (!mkdtemp(&path[0]))
+    return false;
+
+  m_directory = &path[0];
+  return true;
+}
+
+std::string CTSBufferTestSet::BufferFileName(void) const
+{
+  return m_directory + "/live.ts.tsbuffer";
+}
+
+bool CTSBufferTestSet::WriteFile(const std::string& name, int64_t startPosition, int64_t length)
+{
+  std::string path = m_directory + "/" + name;
+  FILE* file = fopen(path.c_str(), "wb");
+  if (!file)
+    return false;
+  AddFile(path);
+
+  std::vector<unsigned char> block(65536);
+  bool bOk = true;
+  for (int64_t done = 0; bOk && done < length; )
+  {
+    size_t count = (size_t) std::min((int64_t) block.size(), length - done);
+    for (size_t i = 0; i < count; i++)
+      block[i] = TestPatternByte(startPosition + done + i);
+    bOk = (fwrite(&block[0], 1, count, file) == count);
+    done += count;
+  }
+
+  return (fclose(file) == 0) && bOk;
+}
+
+bool CTSBufferTestSet::WriteBufferFile(const std::vector<std::string>& names, int64_t currentPosition,
+                                       int32_t filesAdded, int32_t filesRemoved)
+{
+  std::vector<unsigned char> data;
+  data.insert(data.end(), (unsigned char*) &currentPosition, (unsigned char*) (&currentPosition + 1));
+  data.insert(data.end(), (unsigned char*) &filesAdded, (unsigned char*) (&filesAdded + 1));
+  data.insert(data.end(), (unsigned char*) &filesRemoved, (unsigned char*) (&filesRemoved + 1));
+
+  // The server lists its own paths as 16 bit strings, the reader keeps only the name
+  for (std::vector<std::string>::const_iterator it = names.begin(); it != names.end(); ++it)
+  {
+    std::string serverPath = "C:\\timeshift\\" + *it;
+    for (size_t i = 0; i <= serverPath.length(); i++)
+    {
+      uint16_t c = (unsigned char) serverPath.c_str()[i];
+      data.insert(data.end(), (unsigned char*) &c, (unsigned char*) (&c + 1));
+    }
+  }
+  uint16_t terminator = 0;
+  data.insert(data.end(), (unsigned char*) &terminator, (unsigned char*) (&terminator + 1));
+
+  data.insert(data.end(), (unsigned char*) &filesAdded, (unsigned char*) (&filesAdded + 1));
+  data.insert(data.end(), (unsigned char*) &filesRemoved, (unsigned char*) (&filesRemoved + 1));
+
+  // Rewritten in place like the server does, the reader keeps the file open
+  std::string path = BufferFileName();
+  FILE* file = fopen(path.c_str(), "wb");
+  if (!file)
+    return false;
+  AddFile(path);
+
+  bool bOk = (fwrite(&data[0], 1, data.size(), file) == data.size());
+  return (fclose(file) == 0) && bOk;
+}
+
+void CTSBufferTestSet::AddFile(const std::string& path)
+{
+  if (std::find(m_files.begin(), m_files.end(), path) == m_files.end())
+    m_files.push_back(path);
+}
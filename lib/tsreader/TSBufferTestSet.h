@@ -0,0 +1,68 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+/*
+ * Helpers shared by the tsreader unit tests and benchmark. A synthetic
+ * timeshift buffer is written to a temporary directory: a set of buffer
+ * files and the .tsbuffer file listing them, in the layout written by
+ * the MediaPortal TV server. The XBMC helper is backed by stdio.
+ */
+
+#include <string>
+#include <vector>
+#include "platform/os.h"
+
+// Byte stored at a position of the synthetic stream, independent of the file holding it
+inline unsigned char TestPatternByte(int64_t position)
+{
+  return (unsigned char) (position * 7 + (position >> 11));
+}
+
+// Sets up the global XBMC helper used by the tsreader library
+void InitTestXBMC(void);
+void ReleaseTestXBMC(void);
+
+class CTSBufferTestSet
+{
+  public:
+    CTSBufferTestSet();
+    ~CTSBufferTestSet();
+
+    // Creates the temporary directory holding the buffer files
+    bool Create(void);
+
+    // Path of the .tsbuffer file
+    std::string BufferFileName(void) const;
+
+    // Writes the buffer file <name> with <length> bytes of the stream starting at <startPosition>
+    bool WriteFile(const std::string& name, int64_t startPosition, int64_t length);
+
+    // Writes the .tsbuffer file listing <names>, with <currentPosition> bytes written to the last one
+    bool WriteBufferFile(const std::vector<std::string>& names, int64_t currentPosition,
+                         int32_t filesAdded, int32_t filesRemoved);
+
+  private:
+    // Remembers a file to remove with the directory
+    void AddFile(const std::string& path);
+
+    std::string m_directory;
+    std::vector<std::string> m_files;
+};
@@ -19,6 +19,11 @@
 
 #pragma once
 
+#include "libXBMC_addon.h"
+
+// The add-on linking this library provides the helper used for logging and file access
+extern ADDON::CHelper_libXBMC_addon *XBMC;
+
 #ifdef TSREADER_DEBUG
 #define TSDEBUG XBMC->Log
 #else
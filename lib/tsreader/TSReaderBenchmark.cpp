@@ -0,0 +1,102 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Read throughput of MultiFileReader on a synthetic timeshift buffer, run by 'make benchmark'.
+ * Usage: tsreader_benchmark [number of files] [file size in MB]
+ */
+
+#include "TSBufferTestSet.h"
+#include "MultiFileReader.h"
+#include "platform/util/timeutils.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Read sizes used by the add-ons: a TS packet, the demuxers and the input stream
+static const unsigned long READ_SIZES[] = { 188, 4096, 32768 };
+
+int main(int argc, char *argv[])
+{
+  int fileCount = (argc > 1 ? atoi(argv[1]) : 8);
+  int64_t fileLength = (int64_t) (argc > 2 ? atoi(argv[2]) : 32) * 1024 * 1024;
+  if (fileCount <= 0 || fileLength <= 0)
+  {
+    fprintf(stderr, "usage: %s [number of files] [file size in MB]\n", argv[0]);
+    return 1;
+  }
+
+  InitTestXBMC();
+
+  CTSBufferTestSet set;
+  std::vector<std::string> names;
+  bool bOk = set.Create();
+  for (int i = 0; bOk && i < fileCount; i++)
+  {
+    char name[32];
+    snprintf(name, sizeof(name), "live.ts%d.ts", i);
+    names.push_back(name);
+    bOk = set.WriteFile(name, i * fileLength, fileLength);
+  }
+  if (!bOk || !set.WriteBufferFile(names, fileLength, fileCount, 0))
+  {
+    fprintf(stderr, "can't write the buffer files\n");
+    return 1;
+  }
+
+  int64_t total = fileCount * fileLength;
+  std::vector<unsigned char> buffer(READ_SIZES[sizeof(READ_SIZES) / sizeof(READ_SIZES[0]) - 1]);
+  int result = 0;
+
+  for (size_t i = 0; i < sizeof(READ_SIZES) / sizeof(READ_SIZES[0]); i++)
+  {
+    MultiFileReader reader;
+    if (reader.OpenFile(set.BufferFileName()) != S_OK)
+    {
+      fprintf(stderr, "can't open %s\n", set.BufferFileName().c_str());
+      result = 1;
+      break;
+    }
+
+    int64_t bytes = 0;
+    int64_t start = PLATFORM::GetTimeMs();
+    while (true)
+    {
+      unsigned long bytesRead = 0;
+      if (reader.Read(&buffer[0], READ_SIZES[i], &bytesRead) != S_OK || bytesRead == 0)
+        break;
+      bytes += bytesRead;
+    }
+    int64_t elapsed = PLATFORM::GetTimeMs() - start;
+    reader.CloseFile();
+
+    if (bytes != total)
+    {
+      fprintf(stderr, "read %lld of %lld bytes\n", (long long) bytes, (long long) total);
+      result = 1;
+      break;
+    }
+
+    printf("%d files of %lld MB, reads of %6lu bytes: %8.1f MB/s\n", fileCount,
+           (long long) (fileLength / (1024 * 1024)), READ_SIZES[i],
+           (double) bytes / (1024 * 1024) / ((elapsed > 0 ? elapsed : 1) / 1000.0));
+  }
+
+  ReleaseTestXBMC();
+  return result;
+}
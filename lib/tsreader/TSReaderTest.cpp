@@ -0,0 +1,230 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Unit tests of MultiFileReader on synthetic timeshift buffers, run by 'make check'
+ */
+
+#include "TSBufferTestSet.h"
+#include "MultiFileReader.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static int g_failures = 0;
+
+#define CHECK(condition) \
+  do { \
+    if (!(condition)) \
+    { \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+      g_failures++; \
+    } \
+  } while (0)
+
+// Exposes the internals checked by the tests
+class CTestMultiFileReader : public MultiFileReader
+{
+  public:
+    using MultiFileReader::FindFile;
+    using MultiFileReader::RefreshTSBufferFile;
+
+    size_t FileCount(void) const { return m_tsFiles.size(); }
+    unsigned long ReadAheadLength(void) const { return m_readAheadLength; }
+};
+
+// Three buffer files, the last one still being written
+static const int64_t FILE_LENGTH[] = { 1000003, 777777, 500000 };
+static const int64_t LAST_FILE_WRITTEN = 123457;
+
+static bool WriteInitialSet(CTSBufferTestSet& set, std::vector<std::string>& names)
+{
+  int64_t position = 0;
+  for (int i = 0; i < 3; i++)
+  {
+    char name[32];
+    snprintf(name, sizeof(name), "live.ts%d.ts", i);
+    names.push_back(name);
+    if (!set.WriteFile(name, position, FILE_LENGTH[i]))
+      return false;
+    position += FILE_LENGTH[i];
+  }
+  return set.WriteBufferFile(names, LAST_FILE_WRITTEN, 3, 0);
+}
+
+// Reads <length> bytes at the current position and compares them with the pattern
+static int64_t ReadAndVerify(MultiFileReader& reader, int64_t length)
+{
+  std::vector<unsigned char> buffer((size_t) length);
+  unsigned long bytesRead = 0;
+  int64_t position = reader.GetFilePointer();
+
+  if (reader.Read(&buffer[0], (unsigned long) length, &bytesRead) != S_OK)
+    return -1;
+
+  for (unsigned long i = 0; i < bytesRead; i++)
+  {
+    if (buffer[i] != TestPatternByte(position + i))
+    {
+      fprintf(stderr, "wrong byte at position %lld\n", (long long) (position + i));
+      return -1;
+    }
+  }
+  return bytesRead;
+}
+
+static void TestFindFile(void)
+{
+  CTSBufferTestSet set;
+  std::vector<std::string> names;
+  CHECK(set.Create() && WriteInitialSet(set, names));
+
+  CTestMultiFileReader reader;
+  CHECK(reader.OpenFile(set.BufferFileName()) == S_OK);
+  CHECK(reader.FileCount() == 3);
+
+  int64_t end = FILE_LENGTH[0] + FILE_LENGTH[1] + LAST_FILE_WRITTEN;
+  CHECK(reader.GetFileSize() == end);
+
+  CHECK(reader.FindFile(-1) == NULL);
+  int64_t start = 0;
+  for (int i = 0; i < 3; i++)
+  {
+    int64_t length = (i == 2 ? LAST_FILE_WRITTEN : FILE_LENGTH[i]);
+    MultiFileReaderFile* first = reader.FindFile(start);
+    MultiFileReaderFile* last = reader.FindFile(start + length - 1);
+    CHECK(first != NULL && first->filename.find(names[i]) != std::string::npos);
+    CHECK(first != NULL && first->startPosition == start);
+    CHECK(last == first);
+    start += length;
+  }
+  CHECK(reader.FindFile(end) == NULL);
+
+  reader.CloseFile();
+}
+
+static void TestReadAcrossFiles(void)
+{
+  CTSBufferTestSet set;
+  std::vector<std::string> names;
+  CHECK(set.Create() && WriteInitialSet(set, names));
+
+  CTestMultiFileReader reader;
+  CHECK(reader.OpenFile(set.BufferFileName()) == S_OK);
+
+  // Reads of any size, several of them spanning two files
+  int64_t end = FILE_LENGTH[0] + FILE_LENGTH[1] + LAST_FILE_WRITTEN;
+  int64_t total = 0;
+  srand(1);
+  while (true)
+  {
+    int64_t bytesRead = ReadAndVerify(reader, 1 + rand() % 100000);
+    CHECK(bytesRead >= 0);
+    if (bytesRead <= 0)
+      break;
+    total += bytesRead;
+  }
+  CHECK(total == end);
+  CHECK(reader.GetFilePointer() == end);
+
+  // Back across the boundary of the first two files, served by a new block
+  CHECK(reader.SetFilePointer(FILE_LENGTH[0] - 10, FILE_BEGIN) == FILE_LENGTH[0] - 10);
+  CHECK(ReadAndVerify(reader, 20) == 20);
+  CHECK(reader.GetFilePointer() == FILE_LENGTH[0] + 10);
+
+  // The exact end of a file
+  CHECK(reader.SetFilePointer(FILE_LENGTH[0] + FILE_LENGTH[1] - 1, FILE_BEGIN) == FILE_LENGTH[0] + FILE_LENGTH[1] - 1);
+  CHECK(ReadAndVerify(reader, 1) == 1);
+  CHECK(ReadAndVerify(reader, 1) == 1);
+
+  reader.CloseFile();
+}
+
+static void TestFilesRemoved(void)
+{
+  CTSBufferTestSet set;
+  std::vector<std::string> names;
+  CHECK(set.Create() && WriteInitialSet(set, names));
+
+  CTestMultiFileReader reader;
+  CHECK(reader.OpenFile(set.BufferFileName()) == S_OK);
+
+  // Leave a block of the second file in memory
+  CHECK(reader.SetFilePointer(FILE_LENGTH[0] + 1000, FILE_BEGIN) == FILE_LENGTH[0] + 1000);
+  CHECK(ReadAndVerify(reader, 1000) == 1000);
+  CHECK(reader.ReadAheadLength() > 0);
+
+  // The server completes the last file and reuses the first one for new data
+  int64_t thirdStart = FILE_LENGTH[0] + FILE_LENGTH[1];
+  int64_t fourthStart = thirdStart + FILE_LENGTH[2];
+  int64_t fourthWritten = 300001;
+  CHECK(set.WriteFile(names[2], thirdStart, FILE_LENGTH[2]));
+  CHECK(set.WriteFile(names[0], fourthStart, fourthWritten));
+  std::vector<std::string> newNames(names.begin() + 1, names.end());
+  newNames.push_back(names[0]);
+  CHECK(set.WriteBufferFile(newNames, fourthWritten, 4, 1));
+
+  CHECK(reader.RefreshTSBufferFile() == S_OK);
+  CHECK(reader.ReadAheadLength() == 0);
+  CHECK(reader.FileCount() == 3);
+  CHECK(reader.FindFile(FILE_LENGTH[0] - 1) == NULL);
+  CHECK(reader.FindFile(FILE_LENGTH[0]) != NULL);
+  CHECK(reader.GetFileSize() == fourthStart + fourthWritten - FILE_LENGTH[0]);
+
+  MultiFileReaderFile* fourth = reader.FindFile(fourthStart);
+  CHECK(fourth != NULL && fourth->filename.find(names[0]) != std::string::npos);
+  CHECK(fourth != NULL && fourth->startPosition == fourthStart);
+
+  // Everything left reads the new data, including the reused file
+  int64_t total = 0;
+  while (true)
+  {
+    int64_t bytesRead = ReadAndVerify(reader, 65536);
+    CHECK(bytesRead >= 0);
+    if (bytesRead <= 0)
+      break;
+    total += bytesRead;
+  }
+  CHECK(total == fourthStart + fourthWritten - (FILE_LENGTH[0] + 2000));
+
+  // Seeking back into the removed file stops at the start of the buffer
+  CHECK(reader.SetFilePointer(-fourthStart, FILE_CURRENT) == FILE_LENGTH[0]);
+  CHECK(ReadAndVerify(reader, 100) == 100);
+  CHECK(reader.GetFilePointer() == FILE_LENGTH[0] + 100);
+
+  reader.CloseFile();
+}
+
+int main(int argc, char *argv[])
+{
+  InitTestXBMC();
+
+  TestFindFile();
+  TestReadAcrossFiles();
+  TestFilesRemoved();
+
+  ReleaseTestXBMC();
+
+  if (g_failures > 0)
+  {
+    fprintf(stderr, "%d checks failed\n", g_failures);
+    return 1;
+  }
+  printf("all tsreader tests passed\n");
+  return 0;
+}